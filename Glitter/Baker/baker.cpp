@@ -0,0 +1,80 @@
+// Local Headers
+#include "compress.hpp"
+#include "platform.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Mirage::Clock;
+    using Mirage::milliseconds;
+
+    // Command Line Settings
+    struct Settings {
+        Mirage::BlockFormat format = Mirage::Automatic;
+        std::vector<std::string> images;
+    };
+
+    bool parse(int argc, char * argv[], Settings & settings)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool value = i + 1 < argc;
+            if (arg == "--format" && value)
+            {
+                std::string format = argv[++i];
+                     if (format == "auto") settings.format = Mirage::Automatic;
+                else if (format == "bc1")  settings.format = Mirage::BC1;
+                else if (format == "bc3")  settings.format = Mirage::BC3;
+                else if (format == "bc5")  settings.format = Mirage::BC5;
+                else if (format == "bc7")  settings.format = Mirage::BC7;
+                else return false;
+            }
+            else if (arg.compare(0, 2, "--") != 0) settings.images.push_back(arg);
+            else return false;
+        }
+        return !settings.images.empty();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    Settings settings;
+    if (!parse(argc, argv, settings))
+    {
+        fprintf(stderr, "Usage: %s [--format auto|bc1|bc3|bc5|bc7] image ...\n"
+                        "Writes each image's mip chain, block compressed, to image.dds\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Bake Images in Parallel; Each One Also Compresses Its Block Rows in Parallel
+    std::atomic<std::size_t> failed(0);
+    auto start = Clock::now();
+    Mirage::ThreadPool::global().parallel(settings.images.size(), [&](std::size_t i) {
+        auto begin = Clock::now();
+        auto & source = settings.images[i];
+        auto destination = Mirage::CompressedTexture::path(source);
+        Mirage::BlockFormat chosen = settings.format;
+        if (!Mirage::CompressedTexture::bake(source, destination, settings.format, & chosen))
+        {
+            fprintf(stderr, "Failed to Bake Texture %s\n", source.c_str());
+            failed++;
+            return;
+        }
+        Mirage::CompressedTexture baked(destination);
+        fprintf(stderr, "%s -> %s: %s, %zu levels, %.1f KB, %.1f ms\n", source.c_str(), destination.c_str(),
+                Mirage::name(chosen), baked.levels().size(), baked.size() / 1024.0, milliseconds(begin));
+    });
+
+    fprintf(stderr, "baked %zu of %zu images in %.1f ms\n", settings.images.size() - failed,
+            settings.images.size(), milliseconds(start));
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
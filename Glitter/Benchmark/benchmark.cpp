@@ -0,0 +1,804 @@
+// Local Headers
+#include "animation.hpp"
+#include "compiler.hpp"
+#include "lighting.hpp"
+#include "mesh.hpp"
+#include "occlusion.hpp"
+#include "physics.hpp"
+#include "platform.hpp"
+#include "scene.hpp"
+#include "shader.hpp"
+#include "threadpool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Mirage::Clock;
+    using Mirage::milliseconds;
+
+    // Command Line Settings; Defaults Keep a Software Rasterizer Run Under a Minute
+    struct Settings {
+        int frames = 300;
+        int warmup = 30;
+        int width  = 1280;
+        int height = 720;
+        bool cull  = true;
+        bool queue = false;
+        bool occlusion = false;
+        bool queries   = false;
+        float lodError = 1.0f;
+        int nodes  = 100000;
+        int characters = 256;
+        int lights = 1024;
+        std::string output;
+        Mirage::ImportOptions options;
+        std::vector<std::string> models;
+    };
+
+    // One Mesh Placed in the World, Optionally Moved by a Physics Body
+    struct Instance {
+        std::unique_ptr<Mirage::Mesh> mesh;
+        glm::mat4 model;
+        std::size_t body = ~std::size_t(0);
+    };
+
+    struct Scene {
+        std::string name;
+        std::vector<Instance> instances;
+        std::unique_ptr<Mirage::Physics> physics;
+
+        // Instanced Scenes Draw One Mesh at Every Position, Spinning Each Frame
+        std::unique_ptr<Mirage::Mesh> shared;
+        std::unique_ptr<Mirage::InstanceBuffer> buffer;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::mat4> transforms;
+        std::vector<glm::vec4> colors;
+
+        // Animated Scenes Pose Copies of the Shared Mesh Instead
+        std::unique_ptr<Mirage::Animator> animator;
+
+        // Lit Scenes Bin Their Lights into Clusters Every Frame; Each Light Circles Its Anchor
+        std::unique_ptr<Mirage::ClusteredLights> clusters;
+        std::vector<Mirage::Light> lights;
+        std::vector<glm::vec3> anchors;
+        float  radius;
+        double load;
+        std::size_t peak = 0; // Bytes Held While Importing from File
+    };
+
+    struct Result {
+        std::string name;
+        double load;
+        std::size_t peak;
+        double mean, p50, p95, p99, max;
+        double draws;           // Means per Measured Frame
+        double triangles;
+        double visible;
+        double culled;
+        double occluded;
+        double discarded;
+        double bin;             // Mean Milliseconds Binning Lights
+        std::size_t crowded;    // Most Lights in One Cluster Over the Run
+        std::size_t changes;
+        std::size_t skipped;
+    };
+
+    // Scene Graph Propagation Timed Apart from Drawing
+    struct Hierarchy {
+        std::size_t nodes   = 0;
+        std::size_t updated = 0;
+        double p50, p99, upload;
+    };
+
+    // Nearest-Rank Percentile of Sorted Samples
+    double percentile(std::vector<double> const & sorted, double p)
+    {
+        if (sorted.empty()) return 0.0;
+        auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+    }
+
+    // Latitude-Longitude Sphere with the Given Tessellation
+    void sphere(int slices, int stacks, std::vector<Mirage::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        const float pi = 3.14159265358979f;
+        for (int i = 0; i <= stacks; i++)
+        for (int j = 0; j <= slices; j++)
+        {
+            float theta = pi * i / stacks, phi = 2.0f * pi * j / slices;
+            Mirage::Vertex vertex;
+            vertex.normal   = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.position = vertex.normal;
+            vertex.uv       = glm::vec2(float(j) / slices, float(i) / stacks);
+            vertices.push_back(vertex);
+        }
+        for (int i = 0; i < stacks; i++)
+        for (int j = 0; j < slices; j++)
+        {
+            GLuint a = i * (slices + 1) + j, b = a + slices + 1;
+            GLuint quad[] = { a, b, a + 1, a + 1, b, b + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    // Rolling Heightfield Made of a Single Large Draw
+    void terrain(int size, std::vector<Mirage::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        auto height = [](float x, float z) { return 2.0f * std::sin(x * 0.15f) * std::cos(z * 0.1f); };
+        for (int z = 0; z <= size; z++)
+        for (int x = 0; x <= size; x++)
+        {
+            float fx = x - size * 0.5f, fz = z - size * 0.5f;
+            Mirage::Vertex vertex;
+            vertex.position = glm::vec3(fx, height(fx, fz), fz);
+            vertex.normal   = glm::normalize(glm::vec3(height(fx - 1.0f, fz) - height(fx + 1.0f, fz), 2.0f,
+                                                       height(fx, fz - 1.0f) - height(fx, fz + 1.0f)));
+            vertex.uv       = glm::vec2(float(x) / size, float(z) / size);
+            vertices.push_back(vertex);
+        }
+        for (int z = 0; z < size; z++)
+        for (int x = 0; x < size; x++)
+        {
+            GLuint a = z * (size + 1) + x, b = a + size + 1;
+            GLuint quad[] = { a, b, a + 1, a + 1, b, b + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    // Upright Tube Bent by a Chain of Joints, with a Wave Running Up It
+    std::shared_ptr<Mirage::Skeleton> tentacle(int joints, std::vector<Mirage::Vertex> & vertices,
+                                               std::vector<GLuint> & indices,
+                                               std::vector<Mirage::VertexWeights> & weights)
+    {
+        const float pi = 3.14159265358979f, segment = 0.5f, radius = 0.2f;
+        auto skeleton = std::make_shared<Mirage::Skeleton>();
+        Mirage::Clip clip;
+        clip.name = "wave";
+        clip.duration = 1.0f;
+        for (int i = 0; i < joints; i++)
+        {
+            // Offsets Undo Each Joint's Rest Height, so the Bind Pose Skins to Itself
+            auto parent = i == 0 ? Mirage::Skeleton::none : static_cast<std::uint32_t>(i - 1);
+            auto joint  = skeleton->joint(parent, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, i ? segment : 0.0f, 0.0f)),
+                                          "joint" + std::to_string(i));
+            skeleton->bone(joint, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -segment * i, 0.0f)));
+            Mirage::Channel channel;
+            channel.joint = joint;
+            for (int k = 0; k <= 8; k++)
+            {
+                float t = k / 8.0f, angle = 0.35f * std::sin(2.0f * pi * t + 0.8f * i);
+                channel.rotations.push_back(std::make_pair(t, glm::quat(std::cos(angle * 0.5f), 0.0f, 0.0f, std::sin(angle * 0.5f))));
+            }
+            clip.channels.push_back(channel);
+        }
+        skeleton->add(clip);
+
+        // Each Ring Is Shared Between the Two Joints Nearest It
+        int slices = 12, rings = joints * 4;
+        for (int i = 0; i <= rings; i++)
+        for (int j = 0; j <= slices; j++)
+        {
+            float height = segment * joints * i / rings, phi = 2.0f * pi * j / slices;
+            Mirage::Vertex vertex;
+            vertex.normal   = glm::vec3(std::cos(phi), 0.0f, std::sin(phi));
+            vertex.position = glm::vec3(radius * vertex.normal.x, height, radius * vertex.normal.z);
+            vertex.uv       = glm::vec2(float(j) / slices, float(i) / rings);
+            vertices.push_back(vertex);
+
+            float along = std::min(std::max(height / segment - 0.5f, 0.0f), joints - 1.0f);
+            int lower = std::min(static_cast<int>(along), joints - 1), upper = std::min(lower + 1, joints - 1);
+            Mirage::VertexWeights weight = { { static_cast<GLushort>(lower), static_cast<GLushort>(upper), 0, 0 },
+                                             { 1.0f - (along - lower), along - lower, 0.0f, 0.0f } };
+            weights.push_back(weight);
+        }
+        for (int i = 0; i < rings;  i++)
+        for (int j = 0; j < slices; j++)
+        {
+            GLuint a = i * (slices + 1) + j, b = a + slices + 1;
+            GLuint quad[] = { a, b, a + 1, a + 1, b, b + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+        return skeleton;
+    }
+
+    Scene spheres()
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = "spheres"; scene.radius = 40.0f;
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        sphere(32, 16, vertices, indices);
+        for (int z = 0; z < 16; z++)
+        for (int x = 0; x < 16; x++)
+        {
+            Instance instance;
+            instance.mesh.reset(new Mirage::Mesh(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                                                 std::multimap<GLuint, std::string>()));
+            instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 3.0f - 22.5f, 0.0f, z * 3.0f - 22.5f));
+            scene.instances.push_back(std::move(instance));
+        }   scene.load = milliseconds(start);
+        return scene;
+    }
+
+    Scene heightfield()
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = "terrain"; scene.radius = 160.0f;
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        terrain(256, vertices, indices);
+        Instance instance;
+        instance.mesh.reset(new Mirage::Mesh(std::move(vertices), std::move(indices), std::multimap<GLuint, std::string>()));
+        instance.model = glm::mat4(1.0f);
+        scene.instances.push_back(std::move(instance));
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    // Spheres Dropped onto the Heightfield; Simulated on the Physics Thread While Rendering
+    Scene rigidBodies()
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = "physics"; scene.radius = 60.0f;
+        scene.physics.reset(new Mirage::Physics());
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        terrain(64, vertices, indices);
+        Instance ground;
+        ground.mesh.reset(new Mirage::Mesh(std::move(vertices), std::move(indices), std::multimap<GLuint, std::string>(), true));
+        ground.model = glm::mat4(1.0f);
+        scene.physics->add(scene.physics->triangleMesh(* ground.mesh), 0.0f, ground.model);
+        scene.instances.push_back(std::move(ground));
+
+        vertices.clear(); indices.clear();
+        sphere(16, 8, vertices, indices);
+        btCollisionShape * hull = nullptr;
+        for (int y = 0; y < 4;  y++)
+        for (int z = 0; z < 16; z++)
+        for (int x = 0; x < 16; x++)
+        {
+            Instance instance;
+            instance.mesh.reset(new Mirage::Mesh(vertices, indices, std::multimap<GLuint, std::string>(), hull == nullptr));
+            if (hull == nullptr) hull = scene.physics->convexHull(* instance.mesh);
+            instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(x * 2.5f - 18.75f, 8.0f + y * 2.5f, z * 2.5f - 18.75f));
+            instance.body  = scene.physics->add(hull, 1.0f, instance.model);
+            scene.instances.push_back(std::move(instance));
+        }   scene.physics->start();
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    // 100k Low-Poly Spheres in One Instanced Draw, with Transforms Streamed Every Frame
+    Scene crowd()
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = "instances"; scene.radius = 120.0f;
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        sphere(8, 4, vertices, indices);
+        scene.shared.reset(new Mirage::Mesh(std::move(vertices), std::move(indices), std::multimap<GLuint, std::string>()));
+        for (int z = 0; z < 50;  z++)
+        for (int y = 0; y < 40;  y++)
+        for (int x = 0; x < 50;  x++)
+        {
+            scene.positions.push_back(glm::vec3(x * 2.0f - 49.0f, y * 2.0f - 39.0f, z * 2.0f - 49.0f));
+            scene.colors.push_back(glm::vec4(x / 50.0f, y / 40.0f, z / 50.0f, 1.0f));
+        }
+        scene.transforms.resize(scene.positions.size());
+        scene.buffer.reset(new Mirage::InstanceBuffer(scene.positions.size()));
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    // Tentacles on a Grid, Each Out of Step with Its Neighbors, Skinned Where the Scene Says
+    Scene characters(Settings const & settings, Mirage::Skinning mode)
+    {
+        auto start = Clock::now();
+        Scene scene;
+        scene.name = mode == Mirage::CpuSkinning ? "characters-cpu" : "characters-gpu";
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        std::vector<Mirage::VertexWeights> weights;
+        auto skeleton = tentacle(8, vertices, indices, weights);
+        scene.shared.reset(new Mirage::Mesh(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                                            weights.data(), skeleton, std::multimap<GLuint, std::string>()));
+        scene.animator.reset(new Mirage::Animator(* scene.shared, settings.characters, mode));
+        auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(settings.characters))));
+        auto & animated = scene.animator->characters();
+        for (std::size_t i = 0; i < animated.size(); i++)
+        {
+            float x = (i % side - side * 0.5f) * 1.5f, z = (i / side - side * 0.5f) * 1.5f;
+            animated[i].model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, z));
+            animated[i].time  = 0.37f * i;
+        }
+        scene.radius = std::max(10.0f, side * 1.5f);
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    // Spheres on Terrain Under Many Small Point and Spot Lights, Shaded by the Clustered Path
+    Scene lighting(Settings const & settings)
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = "lights"; scene.radius = 60.0f;
+        std::vector<Mirage::Vertex> vertices; std::vector<GLuint> indices;
+        terrain(128, vertices, indices);
+        Instance ground;
+        ground.mesh.reset(new Mirage::Mesh(std::move(vertices), std::move(indices), std::multimap<GLuint, std::string>()));
+        ground.model = glm::mat4(1.0f);
+        scene.instances.push_back(std::move(ground));
+
+        vertices.clear(); indices.clear();
+        sphere(16, 8, vertices, indices);
+        for (int z = 0; z < 8; z++)
+        for (int x = 0; x < 8; x++)
+        {
+            Instance instance;
+            instance.mesh.reset(new Mirage::Mesh(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                                                 std::multimap<GLuint, std::string>()));
+            instance.model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x * 14.0f - 49.0f, 4.0f, z * 14.0f - 49.0f)),
+                                        glm::vec3(2.5f));
+            scene.instances.push_back(std::move(instance));
+        }
+
+        // One Light in Four Is a Spot Aimed Down; Colors Are Spread Around the Hue Wheel
+        unsigned int seed = 1;
+        auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+        for (int i = 0; i < settings.lights; i++)
+        {
+            Mirage::Light light;
+            float hue = random() * 6.28318531f;
+            light.color = glm::vec3(0.5f) + 0.5f * glm::vec3(std::cos(hue), std::cos(hue - 2.0943951f), std::cos(hue + 2.0943951f));
+            light.range = 4.0f + 6.0f * random();
+            if (i % 4 == 3)
+            {
+                light.range *= 2.0f;
+                light.inner  = std::cos(glm::radians(20.0f));
+                light.outer  = std::cos(glm::radians(30.0f));
+            }
+            scene.anchors.push_back(glm::vec3(random() * 120.0f - 60.0f, 2.0f + 6.0f * random(), random() * 120.0f - 60.0f));
+            scene.lights.push_back(light);
+        }
+        scene.clusters.reset(new Mirage::ClusteredLights());
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    void illuminate(Scene & scene, float angle)
+    {
+        for (std::size_t i = 0; i < scene.lights.size(); i++)
+        {
+            float phase = angle * (1.0f + (i % 7) * 0.25f) + i;
+            scene.lights[i].position = scene.anchors[i] + glm::vec3(std::cos(phase), 0.0f, std::sin(phase)) * 3.0f;
+        }
+    }
+
+    void animate(Scene & scene, float angle)
+    {
+        const std::size_t chunk = 4096;
+        Mirage::ThreadPool::global().parallel((scene.positions.size() + chunk - 1) / chunk, [&](std::size_t c) {
+            std::size_t end = std::min(scene.positions.size(), (c + 1) * chunk);
+            for (std::size_t i = c * chunk; i < end; i++)
+                scene.transforms[i] = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), scene.positions[i]),
+                                                 angle + i * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(0.5f));
+        });
+        scene.buffer->update(scene.transforms.data(), scene.transforms.size(), scene.colors.data());
+    }
+
+    Scene model(std::string const & filename, Mirage::ImportOptions const & options)
+    {
+        auto start = Clock::now();
+        Scene scene; scene.name = filename; scene.radius = 20.0f;
+        Instance instance;
+        instance.mesh.reset(new Mirage::Mesh(filename, options));
+        instance.model = glm::mat4(1.0f);
+        scene.peak = instance.mesh->imported().peak;
+        scene.instances.push_back(std::move(instance));
+        scene.load = milliseconds(start);
+        return scene;
+    }
+
+    // Fly a Fixed Orbit, so Every Run Sees the Same Frames
+    Result run(Scene & scene, Mirage::Shader & shader, Settings const & settings)
+    {
+        Result result;
+        result.name = scene.name;
+        result.load = scene.load;
+        result.peak = scene.peak;
+        std::vector<double> times;
+        auto projection = glm::perspective(glm::radians(60.0f), float(settings.width) / settings.height,
+                                           0.1f, scene.radius * 4.0f);
+        GLint model = shader.uniform(Mirage::Shader::hash("model"));
+        const std::uint32_t view = Mirage::Shader::hash("view");
+        Mirage::RenderQueue queue;
+        std::vector<double> bins;
+        std::size_t crowded = 0;
+        Mirage::DrawStats drawn;
+        Mirage::OcclusionStats hidden;
+        Mirage::LodSelection selection;
+        selection.scale     = settings.height / (2.0f * std::tan(glm::radians(60.0f) * 0.5f));
+        selection.threshold = settings.lodError;
+        // Occlusion Tests Against Depth Read Back from Earlier Frames at a Quarter of the Resolution
+        std::unique_ptr<Mirage::OcclusionCuller> occlusion;
+        if (settings.occlusion)
+        {
+            occlusion.reset(new Mirage::OcclusionCuller(settings.width / 4, settings.height / 4));
+            Mirage::ShaderCompiler::global().wait();
+            occlusion->queries(settings.queries);
+        }
+        // Camera Matrices Live in a Block Every Program Shares, Uploaded Once per Frame
+        Mirage::UniformBuffer camera(shader, Mirage::Shader::hash("Camera"));
+        camera.set(Mirage::Shader::hash("projection"), projection);
+        shader.activate();
+
+        for (int frame = 0; frame < settings.warmup + settings.frames; frame++)
+        {
+            auto start = Clock::now();
+            float t = float(frame) / (settings.warmup + settings.frames);
+            float angle = 6.28318531f * t;
+            glm::vec3 eye(std::cos(angle) * scene.radius, scene.radius * (0.35f + 0.25f * std::sin(2.0f * angle)),
+                          std::sin(angle) * scene.radius);
+            auto look = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            camera.set(view, look).flush();
+
+            if (scene.physics) scene.physics->sync();
+            for (auto & i : scene.instances)
+                if (scene.physics && i.body != ~std::size_t(0)) i.model = scene.physics->transform(i.body);
+
+            Mirage::Mesh::stats() = Mirage::DrawStats();
+            Mirage::Mesh::beginFrame();
+            if (scene.clusters)
+            {
+                // Lights Are Binned Against This Frame's Camera Before Anything Is Drawn
+                illuminate(scene, angle * 4.0f);
+                scene.clusters->update(scene.lights, look, projection, 0.1f, scene.radius * 4.0f);
+                scene.clusters->bind(shader, settings.width, settings.height);
+                if (frame >= settings.warmup) bins.push_back(scene.clusters->stats().bin);
+                crowded = std::max(crowded, scene.clusters->stats().maximum);
+            }
+            if (occlusion)
+            {
+                occlusion->stats() = Mirage::OcclusionStats();
+                occlusion->update(projection * look);
+            }
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            if (scene.animator)
+            {
+                // Fixed Steps, so Every Run Poses the Same Frames
+                scene.animator->update(1.0f / 60.0f);
+                scene.animator->skin();
+                scene.shared->draw(shader, * scene.animator);
+            }
+            else if (scene.shared)
+            {
+                animate(scene, angle * 4.0f);
+                scene.shared->draw(shader, * scene.buffer);
+            }
+            for (auto & i : scene.instances)
+            {
+                // Levels of Detail Are Chosen in Model Space, so Bring the Camera There
+                if (settings.options.lods)
+                {
+                    selection.eye = glm::vec3(glm::inverse(i.model) * glm::vec4(eye, 1.0f));
+                    i.mesh->select(selection);
+                }
+
+                // Queued Draws Sort by State, Then Front to Back by Distance from the Camera; They
+                // Are Culled the Same Way as Direct Draws, so Both Modes Submit the Same Work
+                if (settings.queue)
+                {
+                    float depth = glm::length(glm::vec3(i.model[3]) - eye) / (scene.radius * 4.0f);
+                    if (settings.cull) i.mesh->enqueue(queue, shader, i.model, Mirage::Frustum(projection * look * i.model), depth);
+                    else i.mesh->enqueue(queue, shader, i.model, depth);
+                    continue;
+                }
+                shader.bind(model, i.model);
+                if (settings.cull && occlusion) i.mesh->draw(shader, * occlusion, i.model);
+                else if (settings.cull) i.mesh->draw(shader, Mirage::Frustum(projection * look * i.model));
+                else i.mesh->draw(shader);
+            }
+
+            queue.execute();
+            queue.clear();
+            if (occlusion) occlusion->capture(settings.width, settings.height, projection * look);
+
+            // Finish so the Sample Includes GPU Work, Not Just Submission
+            glFinish();
+            if (frame < settings.warmup) continue;
+            times.push_back(milliseconds(start));
+
+            // Counters Reset Every Frame, so Sum Them Over the Measured Frames
+            drawn.draws     += Mirage::Mesh::stats().draws;
+            drawn.triangles += Mirage::Mesh::stats().triangles;
+            drawn.visible   += Mirage::Mesh::stats().visible;
+            drawn.culled    += Mirage::Mesh::stats().culled;
+            if (occlusion) hidden.rejected  += occlusion->stats().rejected;
+            if (occlusion) hidden.discarded += occlusion->stats().discarded;
+        }
+
+        double measured  = double(settings.frames);
+        result.draws     = drawn.draws     / measured;
+        result.triangles = drawn.triangles / measured;
+        result.visible   = drawn.visible   / measured;
+        result.culled    = drawn.culled    / measured;
+        result.occluded  = hidden.rejected  / measured;
+        result.discarded = hidden.discarded / measured;
+        result.bin       = bins.empty() ? 0.0 : std::accumulate(bins.begin(), bins.end(), 0.0) / bins.size();
+        result.crowded   = crowded;
+        if (scene.clusters)
+        {
+            auto & binned = scene.clusters->stats();
+            fprintf(stderr, "%s: %zu lights in %zu clusters, %zu references, bin %.3f ms mean, upload %.3f ms, at most %zu per cluster\n",
+                    scene.name.c_str(), scene.lights.size(), binned.clusters, binned.references, result.bin,
+                    binned.upload, crowded);
+        }
+        if (occlusion)
+        {
+            auto & culled = occlusion->stats();
+            fprintf(stderr, "%s: last frame %zu of %zu boxes occluded, %zu queried, %zu discarded, pyramid %.2f ms, test %.2f ms\n",
+                    scene.name.c_str(), culled.rejected, culled.tested, culled.queried, culled.discarded,
+                    culled.build, culled.test);
+        }
+        result.changes   = queue.state().stats().changes();
+        result.skipped   = queue.state().stats().skipped;
+        result.mean = times.empty() ? 0.0 : std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+        std::sort(times.begin(), times.end());
+        result.p50 = percentile(times, 50.0);
+        result.p95 = percentile(times, 95.0);
+        result.p99 = percentile(times, 99.0);
+        result.max = times.empty() ? 0.0 : times.back();
+        return result;
+    }
+
+    // Random Tree Where About One Node in a Hundred Moves Each Frame, Dirtying Its Subtree
+    Hierarchy hierarchy(Settings const & settings)
+    {
+        Hierarchy result;
+        Mirage::SceneGraph graph;
+        unsigned int seed = 1;
+        auto random = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+        for (int i = 0; i < settings.nodes; i++)
+        {
+            auto parent = i == 0 ? Mirage::SceneGraph::none : random() % static_cast<unsigned int>(i);
+            graph.add(parent, glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+        }
+        graph.build();
+        graph.update();
+        graph.upload();
+
+        std::vector<double> times;
+        double uploads = 0.0;
+        for (int frame = 0; frame < settings.warmup + settings.frames; frame++)
+        {
+            float angle = 0.01f * frame;
+            for (int i = 0; i < settings.nodes / 100; i++)
+                graph.transform(random() % settings.nodes,
+                                glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f)));
+            graph.update();
+            auto start = Clock::now();
+            graph.upload();
+            if (frame < settings.warmup) continue;
+            times.push_back(graph.stats().update);
+            uploads += milliseconds(start);
+            result.updated += graph.stats().updated;
+        }
+
+        std::sort(times.begin(), times.end());
+        result.nodes    = graph.size();
+        result.updated /= std::max<std::size_t>(times.size(), 1);
+        result.p50      = percentile(times, 50.0);
+        result.p99      = percentile(times, 99.0);
+        result.upload   = times.empty() ? 0.0 : uploads / times.size();
+        return result;
+    }
+
+    // JSON Strings Here Are Model Paths and Driver Names; Escape the Two Characters That Matter
+    std::string quote(char const * string)
+    {
+        std::string quoted = "\"";
+        for (char const * i = string ? string : ""; * i; i++)
+        {
+            if (* i == '"' || * i == '\\') quoted += '\\';
+            quoted += * i;
+        }   return quoted + "\"";
+    }
+
+    void report(FILE * fd, Settings const & settings, std::vector<Result> const & results, Hierarchy const & tree)
+    {
+        fprintf(fd, "{\n  \"renderer\": %s,\n  \"version\": %s,\n",
+                quote(reinterpret_cast<char const *>(glGetString(GL_RENDERER))).c_str(),
+                quote(reinterpret_cast<char const *>(glGetString(GL_VERSION))).c_str());
+        fprintf(fd, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"scenes\": [",
+                settings.width, settings.height, settings.frames);
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            auto & r = results[i];
+            fprintf(fd, "%s\n    {\"name\": %s, \"load_ms\": %.3f, \"import_peak_bytes\": %zu, \"draw_calls\": %.2f, \"triangles\": %.1f,"
+                        " \"visible\": %.2f, \"culled\": %.2f, \"occluded\": %.2f, \"discarded\": %.2f,"
+                        " \"light_bin_ms\": %.4f, \"max_lights_per_cluster\": %zu,"
+                        " \"state_changes\": %zu, \"state_skipped\": %zu, \"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}}",
+                    i ? "," : "", quote(r.name.c_str()).c_str(), r.load, r.peak, r.draws, r.triangles, r.visible, r.culled,
+                    r.occluded, r.discarded, r.bin, r.crowded,
+                    r.changes, r.skipped,
+                    r.mean, r.p50, r.p95, r.p99, r.max);
+        }
+        fprintf(fd, "\n  ],\n  \"hierarchy\": {\"nodes\": %zu, \"updated\": %zu, \"update_ms\": {\"p50\": %.4f, \"p99\": %.4f}, \"upload_ms\": %.4f}\n}\n",
+                tree.nodes, tree.updated, tree.p50, tree.p99, tree.upload);
+    }
+
+    bool parse(int argc, char * argv[], Settings & settings)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool value = i + 1 < argc;
+                 if (arg == "--frames" && value) settings.frames = std::atoi(argv[++i]);
+            else if (arg == "--warmup" && value) settings.warmup = std::atoi(argv[++i]);
+            else if (arg == "--width"  && value) settings.width  = std::atoi(argv[++i]);
+            else if (arg == "--height" && value) settings.height = std::atoi(argv[++i]);
+            else if (arg == "--output" && value) settings.output = argv[++i];
+            else if (arg == "--nodes"  && value) settings.nodes  = std::atoi(argv[++i]);
+            else if (arg == "--characters" && value) settings.characters = std::atoi(argv[++i]);
+            else if (arg == "--lights" && value) settings.lights = std::atoi(argv[++i]);
+            else if (arg == "--no-cull")  settings.cull = false;
+            else if (arg == "--queue")    settings.queue = true;
+            else if (arg == "--occlusion") settings.occlusion = true;
+            else if (arg == "--queries")  settings.occlusion = settings.queries = true;
+            else if (arg == "--merge")    settings.options.merge    = true;
+            else if (arg == "--quantize") settings.options.quantize = true;
+            else if (arg == "--optimize") settings.options.optimize = true;
+            else if (arg == "--lods" && value)      settings.options.lods = std::atoi(argv[++i]);
+            else if (arg == "--lod-error" && value) settings.lodError = static_cast<float>(std::atof(argv[++i]));
+            else if (arg.compare(0, 2, "--") != 0) settings.models.push_back(arg);
+            else return false;
+        }
+        // Queued Draws Are Not Tested Against the Depth Pyramid, so the Two Would Measure Different Work
+        if (settings.queue && settings.occlusion) return false;
+        return settings.frames > 0 && settings.warmup >= 0 && settings.width > 0 && settings.height > 0
+            && settings.nodes >= 0 && settings.characters >= 0;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    Settings settings;
+    if (!parse(argc, argv, settings))
+    {
+        fprintf(stderr, "Usage: %s [--frames N] [--warmup N] [--width W] [--height H] [--output file.json]\n"
+                        "          [--no-cull] [--queue] [--occlusion] [--queries] [--merge] [--quantize] [--optimize]\n"
+                        "          [--lods N] [--lod-error rms-pixels] [--nodes N] [--characters N]\n"
+                        "          [--lights N]\n"
+                        "          [model ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Hidden Window; on CI Set LIBGL_ALWAYS_SOFTWARE=1 for Mesa llvmpipe
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    auto window = glfwCreateWindow(settings.width, settings.height, "Benchmark", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        fprintf(stderr, "Failed to Create OpenGL Context\n");
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (gladLoadGL() == 0)
+    {
+        fprintf(stderr, "Failed to Initialize GLAD\n");
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    // Render Offscreen, so Results Do Not Depend on the Window System
+    GLuint framebuffer, color, depth;
+    glGenFramebuffers(1, & framebuffer);
+    glGenRenderbuffers(1, & color);
+    glGenRenderbuffers(1, & depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings.width, settings.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, settings.width, settings.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glViewport(0, 0, settings.width, settings.height);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+    std::vector<Result> results;
+    Hierarchy tree;
+    {
+        Mirage::Shader shader, instanced, skinned, lit, merged;
+        shader.attach("benchmark.vert").attach("benchmark.frag").compile();
+        instanced.attach("instanced.vert").attach("instanced.frag").compile();
+        skinned.attach("skinned.vert").attach("benchmark.frag").compile();
+        lit.attach("lit.vert").attach("lit.frag").compile();
+        merged.attach("merged.vert").attach("merged.frag").compile();
+        auto & compiler = Mirage::ShaderCompiler::global();
+        compiler.wait();
+        auto & compiled = compiler.stats();
+        auto & programs = Mirage::ProgramCache::global().stats();
+        fprintf(stderr, "programs: %zu ready in %.2f ms, %zu cached, %zu failed, %d driver threads\n",
+                compiled.programs, compiled.elapsed, compiled.cached, compiled.failed, compiled.threads);
+        fprintf(stderr, "programs: %zu cache hits (load %.2f ms), %zu compiled (compile %.2f ms), %zu rejected\n",
+                programs.hits, programs.load, programs.misses, programs.compile, programs.rejected);
+        if (!shader.ready() || !instanced.ready() || !skinned.ready() || !lit.ready() || !merged.ready() || compiled.failed > 0)
+        {
+            fprintf(stderr, "Failed to Link OpenGL Shaders\n");
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
+
+        // Each Scene Is Loaded, Measured and Freed Before the Next
+        std::vector<std::string> scenes = { "spheres", "terrain", "physics", "instances", "characters-cpu", "characters-gpu", "lights" };
+        scenes.insert(scenes.end(), settings.models.begin(), settings.models.end());
+        for (std::size_t i = 0; i < scenes.size(); i++)
+        {
+            Scene scene = i == 0 ? spheres() : i == 1 ? heightfield() : i == 2 ? rigidBodies()
+                        : i == 3 ? crowd() : i == 4 ? characters(settings, Mirage::CpuSkinning)
+                        : i == 5 ? characters(settings, Mirage::GpuSkinning)
+                        : i == 6 ? lighting(settings) : model(scenes[i], settings.options);
+            bool packed = !scene.instances.empty() && scene.instances.front().mesh->merged();
+            results.push_back(run(scene, scene.animator ? skinned : scene.shared ? instanced
+                                       : scene.clusters ? lit : packed ? merged : shader, settings));
+            fprintf(stderr, "%s: p50 %.2f ms, p99 %.2f ms\n",
+                    scene.name.c_str(), results.back().p50, results.back().p99);
+            if (scene.physics)
+            {
+                auto physics = scene.physics->stats();
+                fprintf(stderr, "%s: %llu steps, %llu dropped, worst step %.2f ms\n", scene.name.c_str(),
+                        static_cast<unsigned long long>(physics.steps),
+                        static_cast<unsigned long long>(physics.dropped), physics.worst);
+            }
+            if (scene.buffer)
+            {
+                // Any Fence Waits Here Mean More Updates Were in Flight Than the Ring Holds
+                auto & stream = scene.buffer->stats();
+                fprintf(stderr, "%s: %zu fence waits (%.2f ms), %zu orphans\n", scene.name.c_str(),
+                        stream.waits, stream.waited, stream.orphans);
+            }
+            if (scene.animator)
+            {
+                // Stats of the Last Frame; Every Frame Does the Same Work
+                auto & animation = scene.animator->stats();
+                fprintf(stderr, "%s: %zu characters, sample %.2f ms, skin %.2f ms, %zu vertices, %.1f MB streamed\n",
+                        scene.name.c_str(), animation.characters, animation.sample, animation.skin,
+                        animation.vertices, animation.bytes / 1048576.0);
+            }
+        }
+
+        tree = hierarchy(settings);
+        fprintf(stderr, "hierarchy: %zu nodes, %zu updated per frame, p50 %.2f ms, p99 %.2f ms, upload %.2f ms\n",
+                tree.nodes, tree.updated, tree.p50, tree.p99, tree.upload);
+    }
+
+    // Report to a File or Standard Output
+    FILE * fd = settings.output.empty() ? stdout : fopen(settings.output.c_str(), "w");
+    if (fd == nullptr) fd = stdout;
+    report(fd, settings, results, tree);
+    if (fd != stdout) fclose(fd);
+
+    glDeleteRenderbuffers(1, & color);
+    glDeleteRenderbuffers(1, & depth);
+    glDeleteFramebuffers(1, & framebuffer);
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,9 @@
 // Local Headers
+#include "compiler.hpp"
 #include "glitter.hpp"
+#include "profiler.hpp"
+#include "program.hpp"
+#include "queue.hpp"
 
 // System Headers
 #include <glad/glad.h>
@@ -8,11 +12,10 @@
 // Standard Headers
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
-
-const char* contentsOfShaderSource(const char* filePath);
+#include <vector>
 
 void framebuffer_size_changed(GLFWwindow* window, int width, int height);
 
@@ -46,55 +49,23 @@ int main(int argc, char * argv[]) {
     fprintf(stderr, "OpenGL %s\n", glGetString(GL_VERSION));
 
     glfwSetFramebufferSizeCallback(mWindow, framebuffer_size_changed);
+
+    // Record Frame Timings When Run with --profile
+    auto & profiler = Mirage::Profiler::global();
+    for (int i = 1; i < argc; i++)
+        if (std::strcmp(argv[i], "--profile") == 0) profiler.enable(true);
     
-    // build and compile our shader program
+    // build and compile our shader program in the background, reusing the driver's
+    // binary from a previous run when the sources and driver are unchanged; the
+    // sources are read off this thread and frames keep coming until it links
     // ------------------------------------
-    // vertex shader
-    int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    const char* vertexShaderSource = contentsOfShaderSource("./vertexShaderSource.vert");
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    // check for shader compile errors
-    int success = 0;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (0 == success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        fprintf(stderr, "Failed to Create OpenGL Vertex Shader:\n%s\n", infoLog);
-        glfwTerminate();
-        return EXIT_FAILURE;
-    }
-    // fragment shader
-    int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fragmentShaderSource = contentsOfShaderSource("./fragmentShaderSource.frag");
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    // check for shader compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (0 == success) {
-      glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-      fprintf(stderr, "Failed to Create OpenGL Fragment Shader:\n%s\n",
-              infoLog);
-      glfwTerminate();
-      return EXIT_FAILURE;
-    }
-    // link shaders
+    auto & compiler = Mirage::ShaderCompiler::global();
+    std::vector<Mirage::ShaderStage> stages = {
+        { GL_VERTEX_SHADER,   "vertexShaderSource.vert",   "" },
+        { GL_FRAGMENT_SHADER, "fragmentShaderSource.frag", "" }
+    };
     int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        fprintf(stderr, "Failed to Link OpenGL Shaders:\n%s\n",
-                infoLog);
-        glfwTerminate();
-        return EXIT_FAILURE;
-    }
-    // delete shaders after linked shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    compiler.submit(shaderProgram, stages, "./");
     
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -150,34 +121,81 @@ int main(int argc, char * argv[]) {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
+    // Draws Go Through a Sorted Queue That Skips Redundant Program and VAO Binds
+    Mirage::RenderQueue queue;
+    Mirage::DrawUniforms uniforms = { glm::mat4(1.0f), glm::vec3(0.0f), glm::vec3(1.0f), -1, -1, -1,
+                                      glm::mat4(1.0f), -1 };
+    std::size_t frames = 0;
+
     // uncomment this call to draw in wireframe polygons.
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     
     // Rendering Loop
     while (glfwWindowShouldClose(mWindow) == false) {
+        profiler.beginFrame();
         if (glfwGetKey(mWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(mWindow, true);
         }
 
-        // Background Fill Color
-        // glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // Programs Become Usable as They Finish; a Failed Link Ends the Run
+        if (compiler.pending() > 0 && compiler.poll() == 0) {
+            auto & programs = Mirage::ProgramCache::global().stats();
+            fprintf(stderr, "Programs: %zu cached (%.2f ms), %zu compiled (%.2f ms), %zu rejected, ready after %.2f ms\n",
+                    programs.hits, programs.load, programs.misses, programs.compile, programs.rejected,
+                    compiler.stats().elapsed);
+        }
+        if (compiler.ready(shaderProgram) && !compiler.linked(shaderProgram)) {
+            fprintf(stderr, "Failed to Link OpenGL Shaders\n");
+            break;
+        }
 
-        // draw our first triangle
-        glUseProgram(shaderProgram);
-        glBindVertexArray(VAO); // bind VAO
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO); // bind EBO
-        //glDrawArrays(GL_TRIANGLES, 0, 3);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO); // unbind EBO
-        glBindVertexArray(0); // unbind VAO
+        {
+            MIRAGE_PROFILE_GPU("render");
+
+            // Background Fill Color
+            // glClearColor(0.25f, 0.25f, 0.25f, 1.0f);
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // draw our first triangle once its program has linked; the EBO is part of the VAO's state
+            if (compiler.linked(shaderProgram)) {
+                Mirage::RenderCommand triangle = { 0, GLuint(shaderProgram), VAO, 0, GL_UNSIGNED_INT,
+                                                   GLsizei(sizeof(indices) / sizeof(indices[0])), 0, 0,
+                                                   0, 0, queue.uniforms(uniforms), -1 };
+                triangle.key = Mirage::RenderQueue::key(0, triangle.program, 0, triangle.vertexArray, 0.0f);
+                queue.push(triangle);
+                queue.execute();
+                queue.clear();
+                glBindVertexArray(0); // unbind VAO
+            }
+            frames++;
+        }
 
         // Flip Buffers and Draw
-        glfwSwapBuffers(mWindow);
-        glfwPollEvents();
+        {
+            MIRAGE_PROFILE_SCOPE("swap");
+            glfwSwapBuffers(mWindow);
+        }
+        {
+            MIRAGE_PROFILE_SCOPE("events");
+            glfwPollEvents();
+        }
+        profiler.endFrame();
     }
 
+    // Write Chrome Trace (Load in chrome://tracing or Perfetto) and CSV Timings
+    if (profiler.enabled()) {
+        profiler.exportTrace("profile.json");
+        profiler.exportCsv("profile.csv");
+        fprintf(stderr, "Profiler: %zu frames written, %zu scopes dropped\n",
+                profiler.frames(), profiler.dropped());
+    }
+
+    // Calls Issued by the Last Frame; Skipped Ones Were Already Bound
+    auto & state = queue.state().stats();
+    fprintf(stderr, "State: %zu frames, %zu changes and %zu skipped in the last\n",
+            frames, state.changes(), state.skipped);
+
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
@@ -191,16 +209,6 @@ int main(int argc, char * argv[]) {
 }
 
 
-const char* contentsOfShaderSource(const char* filePath) {
-    std::ifstream in(filePath);
-    std::string contents((std::istreambuf_iterator<char>(in)),
-                       std::istreambuf_iterator<char>());
-    if (in.is_open()) {
-        in.close();
-    }
-    return contents.c_str();
-}
-
 void framebuffer_size_changed(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
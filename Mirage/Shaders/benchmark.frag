@@ -0,0 +1,11 @@
+#version 330 core
+in vec3 vNormal;
+in vec2 vUV;
+
+out vec4 color;
+
+void main()
+{
+    float light = max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+    color = vec4(vec3(0.15 + 0.85 * light), 1.0);
+}
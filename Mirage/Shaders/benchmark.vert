@@ -0,0 +1,26 @@
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+
+// Shared by Every Program; Filled Once per Frame Through a UniformBuffer
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+uniform mat4 model;
+uniform mat4 node = mat4(1.0);
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec3 positionScale  = vec3(1.0);
+
+out vec3 vNormal;
+out vec2 vUV;
+
+void main()
+{
+    vec3 local  = positionOffset + positionScale * position;
+    vNormal     = mat3(model * node) * normal;
+    vUV         = uv;
+    gl_Position = projection * view * model * node * vec4(local, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+in vec3 vNormal;
+in vec2 vUV;
+in vec4 vTint;
+
+out vec4 color;
+
+void main()
+{
+    float light = max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+    color = vec4(vTint.rgb * (0.15 + 0.85 * light), vTint.a);
+}
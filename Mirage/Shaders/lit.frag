@@ -0,0 +1,46 @@
+#version 330 core
+in vec3  vPosition;
+in vec3  vNormal;
+in vec2  vUV;
+in float vDepth;
+
+// Written by ClusteredLights::bind
+uniform samplerBuffer  lights;       // (Position, Range), (Color, Outer Cosine), (Direction, Inner Cosine)
+uniform usamplerBuffer clusters;     // First Index and Count per Cluster
+uniform usamplerBuffer lightIndices;
+uniform ivec3 clusterGrid;
+uniform ivec3 clusterBase;           // First Texel of the Frame in Each Buffer
+uniform vec2  clusterTile;           // Clusters per Pixel
+uniform vec2  clusterDepth;          // Slice = log(Depth) * x + y
+
+uniform vec3 albedo  = vec3(0.8);
+uniform vec3 ambient = vec3(0.05);
+
+out vec4 color;
+
+void main()
+{
+    ivec3 cell = ivec3(ivec2(gl_FragCoord.xy * clusterTile), int(log(vDepth) * clusterDepth.x + clusterDepth.y));
+    cell = clamp(cell, ivec3(0), clusterGrid - 1);
+    int cluster = (cell.z * clusterGrid.y + cell.y) * clusterGrid.x + cell.x;
+    uvec2 range = texelFetch(clusters, clusterBase.y + cluster).xy;
+
+    vec3 normal = normalize(vNormal);
+    vec3 light  = ambient;
+    for (uint i = 0u; i < range.y; i++)
+    {
+        int index = clusterBase.x + 3 * int(texelFetch(lightIndices, clusterBase.z + int(range.x + i)).x);
+        vec4 position  = texelFetch(lights, index);
+        vec4 radiance  = texelFetch(lights, index + 1);
+        vec4 direction = texelFetch(lights, index + 2);
+
+        // Fades Smoothly to Nothing at the Light's Range, Where Binning Stopped
+        vec3  toLight  = position.xyz - vPosition;
+        float distance = length(toLight);
+        vec3  L        = toLight / max(distance, 1e-4);
+        float falloff  = clamp(1.0 - distance / position.w, 0.0, 1.0);
+        float cone     = radiance.w > -1.0 ? smoothstep(radiance.w, max(direction.w, radiance.w + 1e-4), dot(-L, direction.xyz)) : 1.0;
+        light += radiance.rgb * falloff * falloff * cone * max(dot(normal, L), 0.0);
+    }
+    color = vec4(albedo * light, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+in vec3 vNormal;
+in vec2 vUV;
+flat in uvec4 vMaterial;
+
+uniform sampler2D diffuse;
+
+out vec4 color;
+
+void main()
+{
+    // Draws Whose Texture Set Has No Diffuse Map Would Sample an Unbound Unit
+    vec3 albedo = vMaterial.y > 0u ? texture(diffuse, vUV).rgb : vec3(1.0);
+    float light = max(dot(normalize(vNormal), normalize(vec3(0.3, 1.0, 0.5))), 0.0);
+    color = vec4(albedo * (0.15 + 0.85 * light), 1.0);
+}
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 uv;
+layout (location = 3) in uint draw;
+
+// Shared by Every Program; Filled Once per Frame Through a UniformBuffer
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+uniform mat4 model;
+uniform vec3 positionOffset = vec3(0.0);
+uniform vec3 positionScale  = vec3(1.0);
+uniform usamplerBuffer materials; // (Batch, Diffuse Count, Specular Count, Sub-Mesh) per Draw
+
+out vec3 vNormal;
+out vec2 vUV;
+flat out uvec4 vMaterial;
+
+void main()
+{
+    vec3 local  = positionOffset + positionScale * position;
+    vNormal     = mat3(model) * normal;
+    vUV         = uv;
+    vMaterial   = texelFetch(materials, int(draw));
+    gl_Position = projection * view * model * vec4(local, 1.0);
+}
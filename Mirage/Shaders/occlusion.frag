@@ -0,0 +1,6 @@
+#version 330 core
+
+// Proxies Only Have Their Samples Counted; Color and Depth Writes Are Off
+void main()
+{
+}
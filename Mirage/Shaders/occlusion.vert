@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 corner;
+
+uniform mat4 transform;
+uniform vec3 lower;
+uniform vec3 upper;
+
+void main()
+{
+    gl_Position = transform * vec4(mix(lower, upper, corner), 1.0);
+}
@@ -0,0 +1,40 @@
+#version 330 core
+layout (location = 0)  in vec3 position;
+layout (location = 1)  in vec3 normal;
+layout (location = 2)  in vec2 uv;
+layout (location = 9)  in uvec4 bones;
+layout (location = 10) in vec4 weights;
+
+// Shared by Every Program; Filled Once per Frame Through a UniformBuffer
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+uniform mat4 model;
+uniform mat4 node = mat4(1.0);
+uniform samplerBuffer palettes;
+uniform int palette = 0;
+
+out vec3 vNormal;
+out vec2 vUV;
+
+mat4 bone(uint index)
+{
+    int texel = palette + 4 * int(index);
+    return mat4(texelFetch(palettes, texel),     texelFetch(palettes, texel + 1),
+                texelFetch(palettes, texel + 2), texelFetch(palettes, texel + 3));
+}
+
+void main()
+{
+    // Vertices Without Weights Were Posed on the CPU or Belong to a Rigid Part
+    mat4 skin = mat4(1.0);
+    if (dot(weights, vec4(1.0)) > 0.0)
+        skin = bone(bones.x) * weights.x + bone(bones.y) * weights.y
+             + bone(bones.z) * weights.z + bone(bones.w) * weights.w;
+    mat4 transform = model * node * skin;
+    vNormal     = mat3(transform) * normal;
+    vUV         = uv;
+    gl_Position = projection * view * transform * vec4(position, 1.0);
+}
@@ -0,0 +1,195 @@
+// Local Headers
+#include "animation.hpp"
+#include "platform.hpp"
+#include "threadpool.hpp"
+
+// System Headers
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Characters Posed per Task, and Vertices Blended per Task
+        const std::size_t   kCharacters = 16;
+        const std::uint32_t kVertices   = 4096;
+
+        const glm::mat4 kIdentity(1.0f);
+
+        // Blend Each Vertex's Bones into One Matrix, Then Move Its Position and Normal; Output Is
+        // Written Front to Back in Whole Vertices, Which Suits Write-Combined Mappings
+        void blend(glm::mat4 const * palette, Vertex const * vertices, VertexWeights const * weights,
+                   Vertex * output, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                auto & vertex = vertices[i];
+                auto & weight = weights[i];
+            #ifdef MIRAGE_SSE
+                __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+                for (int j = 0; j < 4; j++)
+                {
+                    float const * m = glm::value_ptr(palette[weight.bones[j]]);
+                    __m128 w = _mm_set1_ps(weight.weights[j]);
+                    c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+                    c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+                    c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+                    c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+                }
+                __m128 position = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertex.position.x)),
+                                                        _mm_mul_ps(c1, _mm_set1_ps(vertex.position.y))),
+                                             _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(vertex.position.z)), c3));
+                __m128 normal   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertex.normal.x)),
+                                                        _mm_mul_ps(c1, _mm_set1_ps(vertex.normal.y))),
+                                             _mm_mul_ps(c2, _mm_set1_ps(vertex.normal.z)));
+
+                // Affine Bones Leave the Normal's Fourth Lane Zero, so All Four Lanes Sum to Its Length
+                __m128 square = _mm_mul_ps(normal, normal);
+                square = _mm_add_ps(square, _mm_shuffle_ps(square, square, _MM_SHUFFLE(2, 3, 0, 1)));
+                square = _mm_add_ps(square, _mm_shuffle_ps(square, square, _MM_SHUFFLE(1, 0, 3, 2)));
+                normal = _mm_div_ps(normal, _mm_sqrt_ps(_mm_max_ps(square, _mm_set1_ps(1e-24f))));
+
+                // Pack (px py pz nx) and (ny nz u v)
+                __m128 uv   = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const *>(& vertex.uv));
+                __m128 join = _mm_shuffle_ps(position, normal, _MM_SHUFFLE(0, 0, 2, 2));
+                float * out = & output[i].position.x;
+                _mm_storeu_ps(out,     _mm_shuffle_ps(position, join, _MM_SHUFFLE(2, 0, 1, 0)));
+                _mm_storeu_ps(out + 4, _mm_shuffle_ps(normal,   uv,   _MM_SHUFFLE(1, 0, 2, 1)));
+            #else
+                glm::mat4 matrix = palette[weight.bones[0]] * weight.weights[0] + palette[weight.bones[1]] * weight.weights[1]
+                                 + palette[weight.bones[2]] * weight.weights[2] + palette[weight.bones[3]] * weight.weights[3];
+                Vertex skinned;
+                skinned.position = glm::vec3(matrix * glm::vec4(vertex.position, 1.0f));
+                skinned.normal   = glm::normalize(glm::vec3(matrix * glm::vec4(vertex.normal, 0.0f)));
+                skinned.uv       = vertex.uv;
+                output[i] = skinned;
+            #endif
+            }
+        }
+    }
+
+    Animator::Animator(Mesh const & mesh, std::size_t count, Skinning mode)
+        : mCharacters(count)
+        , mSkeleton(mesh.mSkeleton.get())
+        , mTexture(0)
+        , mMode(mode)
+    {
+        if (mesh.mSubMeshes.empty()) mParts.push_back(& mesh);
+        for (auto & i : mesh.mSubMeshes) mParts.push_back(i.get());
+    }
+
+    Animator::~Animator()
+    {
+        if (mTexture) glDeleteTextures(1, & mTexture);
+    }
+
+    void Animator::update(float seconds)
+    {
+        // Characters Are Independent, so Each Task Poses a Run of Them Start to Finish
+        auto start = Clock::now();
+        mStats.characters = mCharacters.size();
+        if (mSkeleton == nullptr) return;
+        std::size_t joints = mSkeleton->joints(), bones = mSkeleton->bones();
+        mJoints.resize(mCharacters.size() * joints);
+        mPalettes.resize(mCharacters.size() * bones);
+        auto & clips = mSkeleton->clips();
+        ThreadPool::global().parallel((mCharacters.size() + kCharacters - 1) / kCharacters, [&](std::size_t chunk) {
+            std::size_t end = std::min(mCharacters.size(), (chunk + 1) * kCharacters);
+            for (std::size_t i = chunk * kCharacters; i < end; i++)
+            {
+                // Wrap Here, so Long Runs Keep Their Precision
+                auto & character = mCharacters[i];
+                character.time += seconds * character.speed;
+                if (character.clip < clips.size() && clips[character.clip].duration > 0.0f)
+                    character.time = std::fmod(character.time, clips[character.clip].duration);
+                mSkeleton->sample(character.clip, character.time, & mJoints[i * joints], & mPalettes[i * bones]);
+            }
+        });
+        mStats.sample = milliseconds(start);
+    }
+
+    void Animator::skin()
+    {
+        auto start = Clock::now();
+        mStats.vertices = 0;
+        mStats.bytes    = 0;
+        mStats.skin     = 0.0;
+        mOffsets.clear(); // Offsets Describe Only the Frame This Call Writes; Draws Check Their Layout
+        if (mSkeleton == nullptr || mCharacters.empty() || mSkeleton->bones() == 0) return;
+        if (mPalettes.size() != mCharacters.size() * mSkeleton->bones()) return; // Not Yet Posed
+
+        if (mMode == GpuSkinning)
+        {
+            // Palettes Go Out Back to Back; Shaders Find Theirs by Texel
+            std::size_t bones = mSkeleton->bones();
+            mStats.bytes = mPalettes.size() * sizeof(glm::mat4);
+            if (StreamBuffer::reserve(mPaletteStream, GL_TEXTURE_BUFFER, mStats.bytes))
+            {
+                // The Buffer Texture Spans the Whole Ring, so Palettes Are Read at Any Offset
+                if (mTexture == 0) glGenTextures(1, & mTexture);
+                glBindTexture(GL_TEXTURE_BUFFER, mTexture);
+                glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mPaletteStream->buffer());
+                glBindTexture(GL_TEXTURE_BUFFER, 0);
+            }
+            auto allocation = mPaletteStream->allocate(mStats.bytes, sizeof(glm::vec4));
+            if (allocation.data == nullptr) return;
+            std::copy(mPalettes.begin(), mPalettes.end(), static_cast<glm::mat4 *>(allocation.data));
+            mPaletteStream->flush();
+            mOffsets.resize(mCharacters.size());
+            for (std::size_t i = 0; i < mCharacters.size(); i++)
+                mOffsets[i] = (allocation.offset + static_cast<GLintptr>(i * bones * sizeof(glm::mat4))) / sizeof(glm::vec4);
+        }
+        else
+        {
+            // Lay Out Every Character's Skinned Parts, Then Blend Them in Fixed-Size Tasks
+            std::size_t vertices = 0;
+            for (auto i : mParts) vertices += i->mWeights.size();
+            mStats.vertices = vertices * mCharacters.size();
+            mStats.bytes    = mStats.vertices * sizeof(Vertex);
+            StreamBuffer::reserve(mVertexStream, GL_TEXTURE_BUFFER, mStats.bytes);
+            auto allocation = mVertexStream->allocate(mStats.bytes, sizeof(glm::vec4));
+            if (allocation.data == nullptr) return;
+
+            mOffsets.resize(mCharacters.size() * mParts.size());
+            mTasks.clear();
+            GLintptr offset = allocation.offset;
+            for (std::size_t i = 0; i < mCharacters.size(); i++)
+            for (std::size_t j = 0; j < mParts.size(); j++)
+            {
+                auto count = static_cast<std::uint32_t>(mParts[j]->mWeights.size());
+                mOffsets[i * mParts.size() + j] = offset;
+                offset += static_cast<GLintptr>(count * sizeof(Vertex));
+                for (std::uint32_t k = 0; k < count; k += kVertices)
+                {
+                    Task task = { static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j), k, std::min(kVertices, count - k) };
+                    mTasks.push_back(task);
+                }
+            }
+
+            auto mapped = static_cast<unsigned char *>(allocation.data);
+            std::size_t bones = mSkeleton->bones();
+            ThreadPool::global().parallel(mTasks.size(), [&](std::size_t i) {
+                auto & task = mTasks[i];
+                auto & part = * mParts[task.part];
+                auto output = reinterpret_cast<Vertex *>(mapped + (mOffsets[task.character * mParts.size() + task.part] - allocation.offset));
+                blend(& mPalettes[task.character * bones], & part.mBindPose[task.first], & part.mWeights[task.first],
+                      output + task.first, task.count);
+            });
+            mVertexStream->flush();
+        }
+        mStats.skin = milliseconds(start);
+    }
+
+    glm::mat4 const & Animator::joint(std::size_t character, std::uint32_t joint) const
+    {
+        // Before the First update() Every Joint Is Still at the Model's Origin
+        std::size_t index = mSkeleton ? character * mSkeleton->joints() + joint : mJoints.size();
+        return index < mJoints.size() ? mJoints[index] : kIdentity;
+    }
+};
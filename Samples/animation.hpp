@@ -0,0 +1,104 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+#include "skeleton.hpp"
+#include "stream.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Where Characters Are Skinned; Either Works With the Same Shader and May Change per Frame
+    enum Skinning {
+        CpuSkinning, // Vertices Blended on the Pool and Streamed Whole Each Frame
+        GpuSkinning  // Bone Palettes Streamed into a Buffer Texture and Blended per Vertex
+    };
+
+    // One Animated Copy of a Model
+    struct Character {
+        glm::mat4 model = glm::mat4(1.0f);
+        std::size_t clip = 0;
+        float time  = 0.0f; // Seconds into the Clip
+        float speed = 1.0f;
+    };
+
+    // Poses Many Characters Sharing One Imported Model and Streams What Drawing Them Needs;
+    // Draw Them with Mesh::draw(shader, animator)
+    class Animator
+    {
+    public:
+
+        // Work Done by the Last update() and skin()
+        struct Stats {
+            std::size_t characters = 0;
+            std::size_t vertices   = 0;   // Blended on the CPU
+            std::size_t bytes      = 0;   // Streamed to the GPU
+            double      sample     = 0.0; // Milliseconds
+            double      skin       = 0.0;
+        };
+
+        // Implement Custom Constructor and Destructor; the Mesh Must Outlive the Animator
+         Animator(Mesh const & mesh, std::size_t count, Skinning mode = GpuSkinning);
+        ~Animator();
+
+        // Advance Every Character's Clip and Sample Its Pose, in Parallel Across Characters
+        void update(float seconds);
+
+        // Stream Poses for the Current Mode; Call After update() and Before Drawing
+        void skin();
+
+        // Public Member Functions
+        void mode(Skinning mode) { if (mode != mMode) mOffsets.clear(); mMode = mode; }
+        Skinning mode() const { return mMode; }
+        std::vector<Character> & characters() { return mCharacters; }
+        std::vector<Character> const & characters() const { return mCharacters; }
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        Animator(Animator const &) = delete;
+        Animator & operator=(Animator const &) = delete;
+
+        // Mesh::draw Reads the Streamed Ranges Directly
+        friend class Mesh;
+
+        // Vertices of One Skinned Part of One Character, Blended by One Task
+        struct Task {
+            std::uint32_t character;
+            std::uint32_t part;
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        // Private Member Functions
+        glm::mat4 const & joint(std::size_t character, std::uint32_t joint) const;
+
+        // Private Member Containers
+        std::vector<Mesh const *> mParts;   // Sub-Meshes, or the Mesh Itself if It Has None
+        std::vector<Character> mCharacters;
+        std::vector<glm::mat4> mJoints;     // Every Joint of Every Character
+        std::vector<glm::mat4> mPalettes;   // Every Bone of Every Character
+        std::vector<GLintptr> mOffsets;     // Streamed Vertices per Character and Part, or Palette Texels per Character
+        std::vector<Task> mTasks;
+
+        // Private Member Variables
+        Skeleton const * mSkeleton;
+        std::unique_ptr<StreamBuffer> mVertexStream;
+        std::unique_ptr<StreamBuffer> mPaletteStream;
+        GLuint mTexture; // Views the Palette Stream as RGBA32F Texels
+        Skinning mMode;
+        Stats mStats;
+
+    };
+};
@@ -0,0 +1,170 @@
+// Local Headers
+#include "cache.hpp"
+
+// Standard Headers
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Define Namespace
+namespace Mirage
+{
+    // File Layout: Header, then per Sub-Mesh a Record Followed by Vertices, Indices, Texture
+    // Names and Levels of Detail, Then the Scene Nodes. Every Section Starts on a 4-Byte Boundary.
+    namespace
+    {
+        struct Header {
+            char          magic[4];
+            std::uint32_t version;
+            std::uint64_t key;
+            std::uint32_t flags;
+            std::uint32_t meshes;
+            std::uint32_t nodes;
+        };
+
+        struct Record {
+            std::uint32_t vertices;
+            std::uint32_t indices;
+            std::uint32_t textures;
+            std::uint32_t levels;
+            std::uint32_t node;
+        };
+
+        std::size_t align(std::size_t offset) { return (offset + 3) & ~std::size_t(3); }
+    }
+
+    MeshCache::MeshCache(std::string const & source, unsigned int flags, std::string const & variant)
+        : mFilename(source + variant + ".mcache"), mKey(0), mFlags(flags)
+    {
+        // Key the Cache on the Source Bytes and Variant, so Edits Invalidate It
+        MappedFile file(source);
+        if (file.valid()) mKey = hash(variant.data(), variant.size(), hash(file.data(), file.size()));
+    }
+
+    bool MeshCache::read(std::vector<Entry> & entries, std::vector<Node> & nodes)
+    {
+        entries.clear();
+        nodes.clear();
+        if (mKey == 0) return false;
+        mMapping.reset(new MappedFile(mFilename));
+        if (!mMapping->valid() || mMapping->size() < sizeof(Header)) return false;
+
+        // Reject Foreign, Outdated or Stale Caches
+        auto data = mMapping->data();
+        auto size = mMapping->size();
+        Header header; std::memcpy(& header, data, sizeof(Header));
+        if (std::memcmp(header.magic, "MRGC", 4) != 0
+            || header.version != version
+            || header.key     != mKey
+            || header.flags   != mFlags) return false;
+
+        // Walk Sub-Mesh Records, Aliasing Geometry Directly from the Mapping
+        std::size_t offset = sizeof(Header);
+        for (std::uint32_t i = 0; i < header.meshes; i++)
+        {
+            Record record;
+            if (offset + sizeof(Record) > size) return false;
+            std::memcpy(& record, data + offset, sizeof(Record));
+            offset += sizeof(Record);
+
+            Entry entry;
+            entry.vertexCount = record.vertices;
+            entry.indexCount  = record.indices;
+            entry.node        = record.node;
+            entry.vertices    = reinterpret_cast<Vertex const *>(data + offset);
+            offset += align(record.vertices * sizeof(Vertex));
+            entry.indices     = reinterpret_cast<GLuint const *>(data + offset);
+            offset += align(record.indices * sizeof(GLuint));
+            if (offset > size) return false;
+
+            for (std::uint32_t j = 0; j < record.textures; j++)
+            {
+                std::uint32_t lengths[2];
+                if (offset + sizeof(lengths) > size) return false;
+                std::memcpy(lengths, data + offset, sizeof(lengths));
+                offset += sizeof(lengths);
+                if (offset + lengths[0] + lengths[1] > size) return false;
+
+                TextureSource texture;
+                texture.filename.assign(reinterpret_cast<char const *>(data + offset), lengths[0]);
+                texture.mode.assign(reinterpret_cast<char const *>(data + offset + lengths[0]), lengths[1]);
+                entry.textures.push_back(texture);
+                offset = align(offset + lengths[0] + lengths[1]);
+            }
+
+            if (offset + record.levels * sizeof(LevelOfDetail) > size) return false;
+            entry.levels.resize(record.levels);
+            if (record.levels) std::memcpy(entry.levels.data(), data + offset, record.levels * sizeof(LevelOfDetail));
+            offset += record.levels * sizeof(LevelOfDetail);
+            if (record.node >= header.nodes) return false;
+            entries.push_back(entry);
+        }
+
+        // Scene Nodes Close the File
+        if (offset + header.nodes * sizeof(Node) > size) return false;
+        nodes.resize(header.nodes);
+        if (header.nodes) std::memcpy(nodes.data(), data + offset, header.nodes * sizeof(Node));
+        return true;
+    }
+
+    bool MeshCache::write(std::vector<Entry> const & entries, std::vector<Node> const & nodes)
+    {
+        // Release Any Stale Mapping Before Replacing the File
+        mMapping.reset();
+        if (mKey == 0) return false;
+
+        // Write to a Temporary File First, so Readers Never See a Partial Cache
+        std::string temporary = mFilename + ".tmp";
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        if (!fd) return false;
+
+        static char const padding[4] = {};
+        auto pad = [&](std::size_t bytes) { fd.write(padding, align(bytes) - bytes); };
+
+        Header header = { { 'M', 'R', 'G', 'C' }, version, mKey, mFlags,
+                          static_cast<std::uint32_t>(entries.size()), static_cast<std::uint32_t>(nodes.size()) };
+        fd.write(reinterpret_cast<char const *>(& header), sizeof(Header));
+        for (auto & entry : entries)
+        {
+            Record record = { entry.vertexCount, entry.indexCount,
+                              static_cast<std::uint32_t>(entry.textures.size()),
+                              static_cast<std::uint32_t>(entry.levels.size()), entry.node };
+            fd.write(reinterpret_cast<char const *>(& record), sizeof(Record));
+            fd.write(reinterpret_cast<char const *>(entry.vertices), entry.vertexCount * sizeof(Vertex));
+            pad(entry.vertexCount * sizeof(Vertex));
+            fd.write(reinterpret_cast<char const *>(entry.indices), entry.indexCount * sizeof(GLuint));
+            pad(entry.indexCount * sizeof(GLuint));
+            for (auto & texture : entry.textures)
+            {
+                std::uint32_t lengths[2] = { static_cast<std::uint32_t>(texture.filename.size()),
+                                             static_cast<std::uint32_t>(texture.mode.size()) };
+                fd.write(reinterpret_cast<char const *>(lengths), sizeof(lengths));
+                fd.write(texture.filename.data(), lengths[0]);
+                fd.write(texture.mode.data(), lengths[1]);
+                pad(lengths[0] + lengths[1]);
+            }
+            fd.write(reinterpret_cast<char const *>(entry.levels.data()), entry.levels.size() * sizeof(LevelOfDetail));
+        }
+        fd.write(reinterpret_cast<char const *>(nodes.data()), nodes.size() * sizeof(Node));
+
+        // Publish the Finished Cache
+        fd.close();
+        if (!fd) { std::remove(temporary.c_str()); return false; }
+    #ifdef _WIN32
+        std::remove(mFilename.c_str());
+    #endif
+        if (std::rename(temporary.c_str(), mFilename.c_str()) != 0)
+        {
+            fprintf(stderr, "Failed to Write Mesh Cache %s\n", mFilename.c_str());
+            return false;
+        }   return true;
+    }
+
+    std::uint64_t MeshCache::hash(void const * data, std::size_t size, std::uint64_t seed)
+    {
+        auto bytes = static_cast<unsigned char const *>(data);
+        for (std::size_t i = 0; i < size; i++)
+            seed = (seed ^ bytes[i]) * 1099511628211ull;
+        return seed;
+    }
+};
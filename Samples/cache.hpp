@@ -0,0 +1,67 @@
+#pragma once
+
+// Local Headers
+#include "mapped.hpp"
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Versioned On-Disk Cache of Imported Mesh Geometry
+    class MeshCache
+    {
+    public:
+
+        // Bump Whenever the Layout of Vertex, the File Format or What Is Cached Changes
+        static const std::uint32_t version = 4;
+
+        // Sub-Mesh Record; Pointers Alias the Mapping When Read from Disk
+        struct Entry {
+            Vertex const * vertices;
+            GLuint const * indices;
+            std::uint32_t  vertexCount;
+            std::uint32_t  indexCount;
+            std::vector<TextureSource> textures;
+            std::vector<LevelOfDetail> levels; // Ranges of indices; Empty Without Levels
+            std::uint32_t  node;               // Scene Node Placing This Sub-Mesh
+        };
+
+        // Scene Node in Import Order; Parents Precede Children
+        struct Node {
+            std::uint32_t parent;
+            glm::mat4     transform;
+        };
+
+        // Implement Custom Constructor; Variants Cache Differently Processed Geometry Side by Side
+        MeshCache(std::string const & source, unsigned int flags, std::string const & variant = "");
+
+        // Public Member Functions
+        bool read(std::vector<Entry> & entries, std::vector<Node> & nodes);
+        bool write(std::vector<Entry> const & entries, std::vector<Node> const & nodes);
+
+        // Hash Arbitrary Bytes with 64-bit FNV-1a
+        static std::uint64_t hash(void const * data, std::size_t size,
+                                  std::uint64_t seed = 14695981039346656037ull);
+
+    private:
+
+        // Disable Copying and Assignment
+        MeshCache(MeshCache const &) = delete;
+        MeshCache & operator=(MeshCache const &) = delete;
+
+        // Private Member Containers
+        std::unique_ptr<MappedFile> mMapping;
+        std::string mFilename;
+
+        // Private Member Variables
+        std::uint64_t mKey;
+        std::uint32_t mFlags;
+
+    };
+};
@@ -0,0 +1,134 @@
+// Local Headers
+#include "compiler.hpp"
+#include "platform.hpp"
+#include "shader.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Let the Driver Choose How Many Threads to Compile On
+        const GLuint kDriverThreads = 0xFFFFFFFF;
+    }
+
+    ShaderCompiler & ShaderCompiler::global()
+    {
+        static ShaderCompiler compiler;
+        return compiler;
+    }
+
+    void ShaderCompiler::load(std::vector<ShaderStage> & stages, std::string const & directory)
+    {
+        for (auto & i : stages)
+        {
+            if (!i.source.empty()) continue;
+            std::ifstream fd(directory + i.name);
+            if (!fd) fprintf(stderr, "Missing Shader Source: %s\n", (directory + i.name).c_str());
+            i.source.assign(std::istreambuf_iterator<char>(fd), std::istreambuf_iterator<char>());
+        }
+    }
+
+    void ShaderCompiler::initialize()
+    {
+        if (mInitialized) return;
+        mInitialized = true;
+        if (GLAD_GL_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(kDriverThreads);
+        else if (GLAD_GL_ARB_parallel_shader_compile) glMaxShaderCompilerThreadsARB(kDriverThreads);
+        else return;
+        mParallel = true;
+        glGetIntegerv(GL_MAX_SHADER_COMPILER_THREADS_KHR, & mStats.threads);
+    }
+
+    void ShaderCompiler::submit(GLuint program, std::vector<ShaderStage> const & stages,
+                                std::string const & directory, Shader * shader)
+    {
+        initialize();
+        if (mJobs.empty()) mStart = Clock::now();
+        mStats.programs++;
+        mLinked.erase(program); // A Resubmitted Program Is Not Ready Until It Links Again
+
+        Job job;
+        job.program = program;
+        job.shader  = shader;
+        job.state   = Job::Loading;
+        job.sources = ThreadPool::global().submit([stages, directory]() {
+            auto loaded = stages;
+            load(loaded, directory);
+            return loaded;
+        });
+        mJobs.push_back(std::move(job));
+    }
+
+    std::size_t ShaderCompiler::poll()
+    {
+        return advance(false);
+    }
+
+    void ShaderCompiler::wait()
+    {
+        // Every Compile Is Issued First, so Blocking on Each in Turn Loses No Overlap
+        for (auto & i : mJobs) if (i.state == Job::Loading) i.sources.wait();
+        advance(true);
+    }
+
+    std::size_t ShaderCompiler::advance(bool block)
+    {
+        if (mJobs.empty()) return 0;
+
+        // Issue Every Program Whose Sources Have Arrived Before Checking Any for Completion
+        for (auto & i : mJobs)
+        {
+            if (i.state != Job::Loading) continue;
+            if (i.sources.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+            i.stages = i.sources.get();
+            if (ProgramCache::global().restore(i.program, i.stages)) { i.state = Job::Restored; continue; }
+            ProgramCache::global().submit(i.program, i.stages);
+            i.state = Job::Compiling;
+        }
+
+        // Without Parallel Compile Any Status Query Blocks, so Finish at Most One per Poll
+        bool blocked = false;
+        for (std::size_t i = 0; i < mJobs.size();)
+        {
+            auto & job = mJobs[i];
+            bool done = job.state == Job::Restored || (job.state == Job::Compiling && block);
+            if (job.state == Job::Compiling && !block)
+            {
+                GLint status = GL_FALSE;
+                if (mParallel) glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, & status);
+                else if (!blocked) { blocked = true; status = GL_TRUE; }
+                done = status == GL_TRUE;
+            }
+            if (!done) { i++; continue; }
+
+            if (job.state == Job::Restored) mStats.cached++;
+            complete(job, job.state == Job::Restored || ProgramCache::global().finish(job.program, job.stages));
+            mJobs.erase(mJobs.begin() + i);
+        }
+
+        if (mJobs.empty()) mStats.elapsed += milliseconds(mStart);
+        return mJobs.size();
+    }
+
+    void ShaderCompiler::complete(Job & job, bool linked)
+    {
+        mLinked[job.program] = linked;
+        if (!linked) mStats.failed++;
+        if (job.shader) job.shader->complete(linked);
+    }
+
+    void ShaderCompiler::cancel(GLuint program)
+    {
+        // A Program Already Issued Finishes in the Driver; Deleting It Is the Owner's Job
+        for (auto i = mJobs.begin(); i != mJobs.end(); i++)
+            if (i->program == program) { mJobs.erase(i); break; }
+        mLinked.erase(program);
+    }
+};
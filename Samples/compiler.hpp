@@ -0,0 +1,96 @@
+#pragma once
+
+// Local Headers
+#include "program.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class Shader;
+
+    // Builds Many Programs at Once: Sources Load on the Thread Pool, Every Compile and Link Is
+    // Issued Before Any Is Waited On, and Completion Is Polled Where the Driver Allows It
+    class ShaderCompiler
+    {
+    public:
+
+        // Programs by Outcome, and Wall Time from the First Submit to the Last Completion
+        struct Stats {
+            std::size_t programs = 0;
+            std::size_t cached   = 0;
+            std::size_t failed   = 0;
+            GLint       threads  = 0; // Driver Compile Threads; Zero Without Parallel Compile
+            double      elapsed  = 0.0;
+        };
+
+        // Implement Default Constructor
+        ShaderCompiler() : mParallel(false), mInitialized(false) {}
+
+        // Process-Wide Compiler; Use Only on the GL Thread
+        static ShaderCompiler & global();
+
+        // Fill In Empty Stage Sources from directory + name
+        static void load(std::vector<ShaderStage> & stages, std::string const & directory);
+
+        // Queue a Program; Stages with Empty Sources Are Read from Disk Off This Thread
+        void submit(GLuint program, std::vector<ShaderStage> const & stages,
+                    std::string const & directory = "", Shader * shader = nullptr);
+
+        // Advance Without Blocking Where Possible; Returns the Number of Programs Still Pending
+        std::size_t poll();
+        void wait();
+
+        // Forget a Program Whose Owner Is Going Away, Whether Pending or Done; GL Reuses Names
+        void cancel(GLuint program);
+
+        // Public Member Functions
+        bool ready(GLuint program) const { return mLinked.count(program) > 0; }
+        bool linked(GLuint program) const { auto i = mLinked.find(program); return i != mLinked.end() && i->second; }
+        std::size_t pending() const { return mJobs.size(); }
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        ShaderCompiler(ShaderCompiler const &) = delete;
+        ShaderCompiler & operator=(ShaderCompiler const &) = delete;
+
+        // One Program on Its Way from Files to a Linked Program
+        struct Job {
+            enum State { Loading, Compiling, Restored };
+            GLuint program;
+            Shader * shader;
+            std::future<std::vector<ShaderStage>> sources;
+            std::vector<ShaderStage> stages;
+            State state;
+        };
+
+        // Private Member Functions
+        void initialize();
+        std::size_t advance(bool block);
+        void complete(Job & job, bool linked);
+
+        // Private Member Containers
+        std::vector<Job> mJobs;
+        std::map<GLuint, bool> mLinked;
+
+        // Private Member Variables
+        bool mParallel;
+        bool mInitialized;
+        std::chrono::steady_clock::time_point mStart;
+        Stats mStats;
+
+    };
+};
@@ -0,0 +1,510 @@
+// Local Headers
+#include "compress.hpp"
+#include "threadpool.hpp"
+
+// System Headers
+#include <stb_image.h>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Sixteen Texels of One 4x4 Block, as RGBA in [0, 255]
+        typedef float Texels[16][4];
+
+        std::uint32_t fourcc(char a, char b, char c, char d)
+        {
+            return std::uint32_t(a) | std::uint32_t(b) << 8 | std::uint32_t(c) << 16 | std::uint32_t(d) << 24;
+        }
+
+        // DDS Header Fields, Counted in Words from the Magic Number
+        const std::size_t kHeaderWords = 32;
+        const std::size_t kExtendedWords = 5;
+        enum Field { Magic = 0, Size = 1, Flags = 2, Height = 3, Width = 4, LinearSize = 5,
+                     MipMapCount = 7, FormatSize = 19, FormatFlags = 20, FourCC = 21, Caps = 27 };
+
+        // BC7 Interpolation Weights for 4-Bit Indices, out of 64
+        const int kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        // Appends Fields Least Significant Bit First into a Zeroed Block
+        struct BitWriter {
+            unsigned char * block;
+            unsigned int position;
+
+            void put(unsigned int value, unsigned int bits)
+            {
+                for (unsigned int i = 0; i < bits; i++, position++)
+                    if ((value >> i) & 1) block[position >> 3] |= static_cast<unsigned char>(1 << (position & 7));
+            }
+        };
+
+        float squared(float const * a, float const * b, int channels)
+        {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) sum += (a[c] - b[c]) * (a[c] - b[c]);
+            return sum;
+        }
+
+        // Ends of the Texels' Principal Axis, Found by Power Iteration on Their Covariance
+        void principal(Texels const & texels, int channels, float low[4], float high[4])
+        {
+            float mean[4] = {}, covariance[4][4] = {};
+            for (int i = 0; i < 16; i++) for (int c = 0; c < channels; c++) mean[c] += texels[i][c] / 16.0f;
+            for (int i = 0; i < 16; i++)
+                for (int a = 0; a < channels; a++)
+                    for (int b = 0; b < channels; b++)
+                        covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+
+            float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = {}, largest = 0.0f;
+                for (int a = 0; a < channels; a++)
+                    for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+                for (int a = 0; a < channels; a++) largest = std::max(largest, std::fabs(next[a]));
+                if (largest == 0.0f) break;
+                for (int a = 0; a < channels; a++) axis[a] = next[a] / largest;
+            }
+
+            float length = 0.0f, minimum = 0.0f, maximum = 0.0f;
+            for (int c = 0; c < channels; c++) length += axis[c] * axis[c];
+            for (int i = 0; i < 16; i++)
+            {
+                float t = 0.0f;
+                for (int c = 0; c < channels; c++) t += (texels[i][c] - mean[c]) * axis[c];
+                minimum = std::min(minimum, t / length);
+                maximum = std::max(maximum, t / length);
+            }
+            for (int c = 0; c < channels; c++)
+            {
+                low[c]  = std::min(std::max(mean[c] + minimum * axis[c], 0.0f), 255.0f);
+                high[c] = std::min(std::max(mean[c] + maximum * axis[c], 0.0f), 255.0f);
+            }
+        }
+
+        // Least-Squares Endpoints for Fixed Weights, Where 0 Selects the First and 1 the Second
+        bool refine(Texels const & texels, int channels, float const weights[16], float first[4], float second[4])
+        {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[4] = {}, bx[4] = {};
+            for (int i = 0; i < 16; i++)
+            {
+                float a = 1.0f - weights[i], b = weights[i];
+                aa += a * a; ab += a * b; bb += b * b;
+                for (int c = 0; c < channels; c++) { ax[c] += a * texels[i][c]; bx[c] += b * texels[i][c]; }
+            }
+            float determinant = aa * bb - ab * ab;
+            if (std::fabs(determinant) < 1e-6f) return false;
+            for (int c = 0; c < channels; c++)
+            {
+                first[c]  = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+                second[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+            }   return true;
+        }
+
+        std::uint16_t pack565(float const color[4])
+        {
+            auto quantize = [](float value, int range) {
+                return static_cast<std::uint16_t>(std::min(std::max(int(value * range / 255.0f + 0.5f), 0), range));
+            };
+            return static_cast<std::uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+        }
+
+        void unpack565(std::uint16_t packed, float color[4])
+        {
+            int r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+            color[0] = float(r << 3 | r >> 2);
+            color[1] = float(g << 2 | g >> 4);
+            color[2] = float(b << 3 | b >> 2);
+            color[3] = 255.0f;
+        }
+
+        // Four-Color BC1 Block; Returns the Squared Error and the Weight Each Texel Decodes To
+        float encodeColor(Texels const & texels, float const first[4], float const second[4],
+                          unsigned char * block, float ends[2][4], float weights[16])
+        {
+            std::uint16_t c0 = pack565(first), c1 = pack565(second);
+            if (c0 < c1) std::swap(c0, c1);
+            float palette[4][4];
+            unpack565(c0, palette[0]);
+            unpack565(c1, palette[1]);
+            for (int c = 0; c < 3; c++)
+            {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+            std::memcpy(ends, palette, sizeof(float) * 8);
+
+            // Equal Endpoints Switch to Three-Color Mode, Where Only Index 0 Is Safe
+            static const float kPosition[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+            std::uint32_t indices = 0;
+            float error = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0;
+                float nearest = squared(texels[i], palette[0], 3);
+                for (int j = 1; j < 4 && c0 != c1; j++)
+                {
+                    float distance = squared(texels[i], palette[j], 3);
+                    if (distance < nearest) { nearest = distance; best = j; }
+                }
+                indices |= std::uint32_t(best) << (2 * i);
+                weights[i] = kPosition[best];
+                error += nearest;
+            }
+
+            unsigned char encoded[8] = { static_cast<unsigned char>(c0), static_cast<unsigned char>(c0 >> 8),
+                                         static_cast<unsigned char>(c1), static_cast<unsigned char>(c1 >> 8),
+                                         static_cast<unsigned char>(indices),       static_cast<unsigned char>(indices >> 8),
+                                         static_cast<unsigned char>(indices >> 16), static_cast<unsigned char>(indices >> 24) };
+            std::memcpy(block, encoded, sizeof(encoded));
+            return error;
+        }
+
+        // BC4 Channel Block in Eight-Value Mode, Spanning the Channel's Range
+        void encodeChannel(Texels const & texels, int channel, unsigned char * block)
+        {
+            float minimum = 255.0f, maximum = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                minimum = std::min(minimum, texels[i][channel]);
+                maximum = std::max(maximum, texels[i][channel]);
+            }
+            int a0 = int(maximum + 0.5f), a1 = int(minimum + 0.5f);
+            float palette[8] = { float(a0), float(a1) };
+            for (int j = 2; j < 8; j++) palette[j] = ((8 - j) * a0 + (j - 1) * a1) / 7.0f;
+
+            std::uint64_t indices = 0;
+            for (int i = 0; i < 16 && a0 != a1; i++)
+            {
+                int best = 0;
+                for (int j = 1; j < 8; j++)
+                    if (std::fabs(texels[i][channel] - palette[j]) < std::fabs(texels[i][channel] - palette[best])) best = j;
+                indices |= std::uint64_t(best) << (3 * i);
+            }
+            block[0] = static_cast<unsigned char>(a0);
+            block[1] = static_cast<unsigned char>(a1);
+            for (int j = 0; j < 6; j++) block[2 + j] = static_cast<unsigned char>(indices >> (8 * j));
+        }
+
+        // Choose the Shared Low Bit That Brings 7-Bit Endpoint Channels Closest to the Target
+        void quantize(float const target[4], int bits[4], int & parity)
+        {
+            float best = -1.0f;
+            for (int p = 0; p < 2; p++)
+            {
+                int candidate[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++)
+                {
+                    candidate[c] = std::min(std::max(int((target[c] - p) / 2.0f + 0.5f), 0), 127);
+                    float decoded = float(candidate[c] << 1 | p);
+                    error += (decoded - target[c]) * (decoded - target[c]);
+                }
+                if (best >= 0.0f && error >= best) continue;
+                best = error;
+                parity = p;
+                std::copy(candidate, candidate + 4, bits);
+            }
+        }
+
+        // BC7 Mode 6: One Subset, RGBA Endpoints with Per-Endpoint Low Bits, 4-Bit Indices
+        float encodeMode6(Texels const & texels, float const first[4], float const second[4],
+                          unsigned char * block, float ends[2][4], float weights[16])
+        {
+            int bits[2][4], parity[2];
+            quantize(first,  bits[0], parity[0]);
+            quantize(second, bits[1], parity[1]);
+            for (int e = 0; e < 2; e++)
+                for (int c = 0; c < 4; c++) ends[e][c] = float(bits[e][c] << 1 | parity[e]);
+
+            float palette[16][4];
+            for (int j = 0; j < 16; j++)
+                for (int c = 0; c < 4; c++)
+                    palette[j][c] = float((int(ends[0][c]) * (64 - kWeights[j]) + int(ends[1][c]) * kWeights[j] + 32) >> 6);
+
+            int indices[16];
+            float error = 0.0f;
+            for (int i = 0; i < 16; i++)
+            {
+                int best = 0;
+                float nearest = squared(texels[i], palette[0], 4);
+                for (int j = 1; j < 16; j++)
+                {
+                    float distance = squared(texels[i], palette[j], 4);
+                    if (distance < nearest) { nearest = distance; best = j; }
+                }
+                indices[i] = best;
+                error += nearest;
+            }
+
+            // The First Index Is Stored Without Its High Bit, so It Must Be Below 8
+            if (indices[0] >= 8)
+            {
+                for (int c = 0; c < 4; c++) std::swap(bits[0][c], bits[1][c]);
+                std::swap(parity[0], parity[1]);
+                std::swap(ends[0], ends[1]);
+                for (int i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+            }
+            for (int i = 0; i < 16; i++) weights[i] = kWeights[indices[i]] / 64.0f;
+
+            std::memset(block, 0, 16);
+            BitWriter writer = { block, 0 };
+            writer.put(1 << 6, 7);
+            for (int c = 0; c < 4; c++) { writer.put(bits[0][c], 7); writer.put(bits[1][c], 7); }
+            writer.put(parity[0], 1);
+            writer.put(parity[1], 1);
+            writer.put(indices[0], 3);
+            for (int i = 1; i < 16; i++) writer.put(indices[i], 4);
+            return error;
+        }
+
+        // Fit the Principal Axis, Then Keep One Least-Squares Refit if It Lowers the Error
+        template<typename Encoder>
+        void fit(Texels const & texels, int channels, unsigned char * block, std::size_t bytes, Encoder encode)
+        {
+            float low[4] = {}, high[4] = {}, ends[2][4], weights[16];
+            principal(texels, channels, low, high);
+            float error = encode(texels, high, low, block, ends, weights);
+
+            unsigned char candidate[16];
+            float first[4] = {}, second[4] = {}, refitEnds[2][4], refitWeights[16];
+            if (!refine(texels, channels, weights, first, second)) return;
+            if (encode(texels, first, second, candidate, refitEnds, refitWeights) < error)
+                std::memcpy(block, candidate, bytes);
+        }
+
+        void encode(BlockFormat format, Texels const & texels, unsigned char * block)
+        {
+            switch (format)
+            {
+                case BC3:
+                    encodeChannel(texels, 3, block);
+                    fit(texels, 3, block + 8, 8, encodeColor);
+                    break;
+                case BC5:
+                    encodeChannel(texels, 0, block);
+                    encodeChannel(texels, 1, block + 8);
+                    break;
+                case BC7:
+                    fit(texels, 4, block, 16, encodeMode6);
+                    break;
+                default:
+                    fit(texels, 3, block, 8, encodeColor);
+                    break;
+            }
+        }
+    }
+
+    std::size_t blockBytes(BlockFormat format)
+    {
+        return format == BC1 ? 8 : 16;
+    }
+
+    GLenum internalFormat(BlockFormat format)
+    {
+        switch (format)
+        {
+            case BC1 : return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case BC3 : return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case BC5 : return GL_COMPRESSED_RG_RGTC2;
+            case BC7 : return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            default  : return GL_NONE;
+        }
+    }
+
+    bool supported(BlockFormat format)
+    {
+        switch (format)
+        {
+            case BC1 :
+            case BC3 : return GLAD_GL_EXT_texture_compression_s3tc != 0;
+            case BC5 : return GLAD_GL_VERSION_3_0 || GLAD_GL_ARB_texture_compression_rgtc;
+            case BC7 : return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+            default  : return false;
+        }
+    }
+
+    char const * name(BlockFormat format)
+    {
+        switch (format)
+        {
+            case BC1 : return "BC1";
+            case BC3 : return "BC3";
+            case BC5 : return "BC5";
+            case BC7 : return "BC7";
+            default  : return "Automatic";
+        }
+    }
+
+    std::vector<unsigned char> compress(BlockFormat format, unsigned char const * rgba, int width, int height)
+    {
+        std::size_t columns = (width + 3) / 4, rows = (height + 3) / 4, bytes = blockBytes(format);
+        std::vector<unsigned char> blocks(columns * rows * bytes);
+        ThreadPool::global().parallel(rows, [&](std::size_t y) {
+            Texels texels;
+            for (std::size_t x = 0; x < columns; x++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    int u = std::min(int(x * 4) + i % 4, width  - 1);
+                    int v = std::min(int(y * 4) + i / 4, height - 1);
+                    for (int c = 0; c < 4; c++) texels[i][c] = rgba[(std::size_t(v) * width + u) * 4 + c];
+                }
+                encode(format, texels, & blocks[(y * columns + x) * bytes]);
+            }
+        });
+        return blocks;
+    }
+
+    std::vector<unsigned char> downsample(unsigned char const * rgba, int width, int height)
+    {
+        int w = std::max(width / 2, 1), h = std::max(height / 2, 1);
+        std::vector<unsigned char> result(std::size_t(w) * h * 4);
+        for (int y = 0; y < h; y++)
+        {
+            int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < w; x++)
+            {
+                int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < 4; c++)
+                {
+                    int sum = rgba[(std::size_t(y0) * width + x0) * 4 + c] + rgba[(std::size_t(y0) * width + x1) * 4 + c]
+                            + rgba[(std::size_t(y1) * width + x0) * 4 + c] + rgba[(std::size_t(y1) * width + x1) * 4 + c];
+                    result[(std::size_t(y) * w + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }   return result;
+    }
+
+    CompressedTexture::CompressedTexture(std::string const & filename)
+        : mFile(filename), mFormat(Automatic), mOffset(0), mSize(0)
+    {
+        std::uint32_t header[kHeaderWords];
+        if (!mFile.valid() || mFile.size() < sizeof(header)) return;
+        std::memcpy(header, mFile.data(), sizeof(header));
+        if (header[Magic] != fourcc('D', 'D', 'S', ' ') || header[Size] != 124) return;
+
+        // Read the Format from the DX10 Extension, or from a Legacy FourCC
+        std::size_t offset = sizeof(header);
+        std::uint32_t format = 0;
+        if (header[FourCC] == fourcc('D', 'X', '1', '0'))
+        {
+            std::uint32_t extended[kExtendedWords];
+            if (mFile.size() < offset + sizeof(extended)) return;
+            std::memcpy(extended, mFile.data() + offset, sizeof(extended));
+            offset += sizeof(extended);
+            if (extended[1] != 3 || extended[3] > 1) return; // Single 2D Texture Only
+            format = extended[0];
+        }
+        else if (header[FourCC] == fourcc('D', 'X', 'T', '1')) format = BC1;
+        else if (header[FourCC] == fourcc('D', 'X', 'T', '5')) format = BC3;
+        else if (header[FourCC] == fourcc('A', 'T', 'I', '2') || header[FourCC] == fourcc('B', 'C', '5', 'U')) format = BC5;
+        if (format != BC1 && format != BC3 && format != BC5 && format != BC7) return;
+
+        // Lay Out the Mip Chain, Rejecting Files Too Short to Hold It
+        std::vector<Level> levels;
+        std::size_t size = 0, bytes = blockBytes(BlockFormat(format));
+        int width = int(header[Width]), height = int(header[Height]);
+        std::uint32_t count = std::max(header[MipMapCount], 1u);
+        for (std::uint32_t i = 0; i < count && width > 0 && height > 0; i++)
+        {
+            Level level = { width, height, size, std::size_t((width + 3) / 4) * ((height + 3) / 4) * bytes };
+            if (offset + size + level.size > mFile.size()) return;
+            levels.push_back(level);
+            size += level.size;
+            if (width == 1 && height == 1) break;
+            width  = std::max(width  / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+
+        mLevels = levels;
+        mFormat = BlockFormat(format);
+        mOffset = offset;
+        mSize   = size;
+    }
+
+    std::string CompressedTexture::path(std::string const & source)
+    {
+        auto dot = source.rfind('.');
+        auto slash = source.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return source + ".dds";
+        return source.substr(0, dot) + ".dds";
+    }
+
+    bool CompressedTexture::bake(std::string const & source, std::string const & destination,
+                                 BlockFormat format, BlockFormat * chosen)
+    {
+        int width, height, channels;
+        unsigned char * pixels = stbi_load(source.c_str(), & width, & height, & channels, 0);
+        if (!pixels) return false;
+
+        // Expand to RGBA the Way the Uncompressed Path Samples It: Missing Channels Are 0, Alpha 1
+        std::vector<unsigned char> image(std::size_t(width) * height * 4);
+        bool opaque = true;
+        for (std::size_t i = 0; i < std::size_t(width) * height; i++)
+        {
+            unsigned char texel[4] = { 0, 0, 0, 255 };
+            for (int c = 0; c < channels; c++) texel[c] = pixels[i * channels + c];
+            opaque = opaque && texel[3] == 255;
+            std::memcpy(& image[i * 4], texel, 4);
+        }
+        stbi_image_free(pixels);
+        if (format == Automatic) format = channels == 2 ? BC5 : opaque ? BC1 : BC3;
+        if (chosen) * chosen = format;
+
+        // Filter Each Level from the One Above, Then Compress It
+        std::vector<std::vector<unsigned char>> levels;
+        for (int w = width, h = height;; w = std::max(w / 2, 1), h = std::max(h / 2, 1))
+        {
+            levels.push_back(compress(format, image.data(), w, h));
+            if (w == 1 && h == 1) break;
+            image = downsample(image.data(), w, h);
+        }
+        return write(destination, format, width, height, levels);
+    }
+
+    bool CompressedTexture::write(std::string const & filename, BlockFormat format, int width, int height,
+                                  std::vector<std::vector<unsigned char>> const & levels)
+    {
+        std::uint32_t header[kHeaderWords] = {};
+        header[Magic]       = fourcc('D', 'D', 'S', ' ');
+        header[Size]        = 124;
+        header[Flags]       = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // Caps, Size, Format, Mips, Linear Size
+        header[Height]      = std::uint32_t(height);
+        header[Width]       = std::uint32_t(width);
+        header[LinearSize]  = levels.empty() ? 0 : std::uint32_t(levels.front().size());
+        header[MipMapCount] = std::uint32_t(levels.size());
+        header[FormatSize]  = 32;
+        header[FormatFlags] = 0x4; // FourCC
+        header[FourCC]      = fourcc('D', 'X', '1', '0');
+        header[Caps]        = 0x1000 | 0x400000 | 0x8; // Texture, Mip Map, Complex
+        std::uint32_t extended[kExtendedWords] = { std::uint32_t(format), 3, 0, 1, 0 };
+
+        // Write to a Temporary File First, so the Loader Never Maps a Partial Texture
+        std::string temporary = filename + ".tmp";
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        if (!fd) return false;
+        fd.write(reinterpret_cast<char const *>(header), sizeof(header));
+        fd.write(reinterpret_cast<char const *>(extended), sizeof(extended));
+        for (auto & level : levels) fd.write(reinterpret_cast<char const *>(level.data()), level.size());
+        fd.close();
+        if (!fd) { std::remove(temporary.c_str()); return false; }
+    #ifdef _WIN32
+        std::remove(filename.c_str());
+    #endif
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+        {
+            fprintf(stderr, "Failed to Write Compressed Texture %s\n", filename.c_str());
+            return false;
+        }   return true;
+    }
+};
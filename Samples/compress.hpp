@@ -0,0 +1,86 @@
+#pragma once
+
+// Local Headers
+#include "mapped.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Block-Compressed Formats, Numbered as in DXGI so They Round-Trip Through DDS Files
+    enum BlockFormat {
+        Automatic = 0,  // BC5 for Two Channels, BC3 When Alpha Varies, Otherwise BC1
+        BC1       = 71, // RGB, 4 Bits per Texel
+        BC3       = 77, // RGBA with Interpolated Alpha, 8 Bits per Texel
+        BC5       = 83, // Two Independent Channels, Such as Normal Map XY
+        BC7       = 98  // High-Quality RGBA, 8 Bits per Texel
+    };
+
+    // Format Properties; supported() Reads Extension Flags, so Call It After gladLoadGL
+    std::size_t blockBytes(BlockFormat format);
+    GLenum internalFormat(BlockFormat format);
+    bool supported(BlockFormat format);
+    char const * name(BlockFormat format);
+
+    // Encode One Level of Tightly Packed RGBA8 Texels; Edge Blocks Repeat Their Last Row and Column
+    std::vector<unsigned char> compress(BlockFormat format, unsigned char const * rgba, int width, int height);
+
+    // Halve Each Dimension with a Box Filter, Down to 1x1
+    std::vector<unsigned char> downsample(unsigned char const * rgba, int width, int height);
+
+    // Memory-Mapped DDS File Holding a Block-Compressed Mip Chain
+    class CompressedTexture
+    {
+    public:
+
+        // Mip Level; offset Is Relative to data()
+        struct Level {
+            int width;
+            int height;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        // Implement Custom Constructor; Any Parse Failure Leaves the Texture Invalid
+        explicit CompressedTexture(std::string const & filename);
+
+        // Where the Baked Copy of a Source Image Lives: Its Path with a .dds Extension
+        static std::string path(std::string const & source);
+
+        // Decode, Build the Mip Chain, Compress Every Level and Write a DDS File
+        static bool bake(std::string const & source, std::string const & destination,
+                         BlockFormat format = Automatic, BlockFormat * chosen = nullptr);
+        static bool write(std::string const & filename, BlockFormat format, int width, int height,
+                          std::vector<std::vector<unsigned char>> const & levels);
+
+        // Public Member Functions
+        bool valid() const { return !mLevels.empty(); }
+        BlockFormat format() const { return mFormat; }
+        std::vector<Level> const & levels() const { return mLevels; }
+        unsigned char const * data() const { return mFile.data() + mOffset; }
+        std::size_t size() const { return mSize; }
+
+    private:
+
+        // Disable Copying and Assignment
+        CompressedTexture(CompressedTexture const &) = delete;
+        CompressedTexture & operator=(CompressedTexture const &) = delete;
+
+        // Private Member Containers
+        std::vector<Level> mLevels;
+
+        // Private Member Variables
+        MappedFile  mFile;
+        BlockFormat mFormat;
+        std::size_t mOffset;
+        std::size_t mSize;
+
+    };
+};
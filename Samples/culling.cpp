@@ -0,0 +1,179 @@
+// Local Headers
+#include "culling.hpp"
+#include "mesh.hpp"
+#include "platform.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        const std::int32_t kEmpty = std::numeric_limits<std::int32_t>::min();
+
+        glm::vec3 centroid(Bounds const & bounds) { return (bounds.min + bounds.max) * 0.5f; }
+
+        // Test Four Boxes Against Every Plane; Bit i of Outside Is Set When Box i Is Fully Outside
+        // One Plane, and Bit i of Partial When Box i Straddles at Least One Plane
+        void test(float const * box[6], Frustum const & frustum, int & outside, int & partial)
+        {
+            outside = partial = 0;
+            for (auto & plane : frustum.planes)
+            {
+                // The Positive Vertex Is the Corner Furthest Along the Plane Normal
+                float const * px = plane.x > 0.0f ? box[3] : box[0];
+                float const * py = plane.y > 0.0f ? box[4] : box[1];
+                float const * pz = plane.z > 0.0f ? box[5] : box[2];
+                float const * nx = plane.x > 0.0f ? box[0] : box[3];
+                float const * ny = plane.y > 0.0f ? box[1] : box[4];
+                float const * nz = plane.z > 0.0f ? box[2] : box[5];
+            #ifdef MIRAGE_SSE
+                __m128 a = _mm_set1_ps(plane.x), b = _mm_set1_ps(plane.y);
+                __m128 c = _mm_set1_ps(plane.z), d = _mm_set1_ps(plane.w);
+                __m128 zero = _mm_setzero_ps();
+                __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(px)), _mm_mul_ps(b, _mm_loadu_ps(py))),
+                                      _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(pz)), d));
+                __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(nx)), _mm_mul_ps(b, _mm_loadu_ps(ny))),
+                                      _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(nz)), d));
+                outside |= _mm_movemask_ps(_mm_cmplt_ps(p, zero));
+                partial |= _mm_movemask_ps(_mm_cmplt_ps(n, zero));
+            #else
+                for (int i = 0; i < 4; i++)
+                {
+                    if (plane.x * px[i] + plane.y * py[i] + plane.z * pz[i] + plane.w < 0.0f) outside |= 1 << i;
+                    if (plane.x * nx[i] + plane.y * ny[i] + plane.z * nz[i] + plane.w < 0.0f) partial |= 1 << i;
+                }
+            #endif
+            }
+        }
+    }
+
+    Bounds enclose(Vertex const * vertices, std::size_t count)
+    {
+        Bounds bounds = { glm::vec3(0.0f), glm::vec3(0.0f) };
+        if (count > 0) bounds.min = bounds.max = vertices[0].position;
+        for (std::size_t i = 1; i < count; i++)
+        {
+            bounds.min = glm::min(bounds.min, vertices[i].position);
+            bounds.max = glm::max(bounds.max, vertices[i].position);
+        }   return bounds;
+    }
+
+    Bounds enclose(Bounds const & a, Bounds const & b)
+    {
+        Bounds bounds = { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+        return bounds;
+    }
+
+    Frustum::Frustum(glm::mat4 const & matrix)
+    {
+        // Gribb-Hartmann: Planes Are Sums and Differences of the Matrix Rows
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+        planes[0] = rows[3] + rows[0];
+        planes[1] = rows[3] - rows[0];
+        planes[2] = rows[3] + rows[1];
+        planes[3] = rows[3] - rows[1];
+        planes[4] = rows[3] + rows[2];
+        planes[5] = rows[3] - rows[2];
+    }
+
+    void BoundingVolumeHierarchy::build(std::vector<Bounds> const & bounds)
+    {
+        mNodes.clear();
+        mCount = bounds.size();
+        mRoot  = kEmpty;
+        if (bounds.empty()) return;
+        std::vector<std::uint32_t> items(bounds.size());
+        for (std::size_t i = 0; i < items.size(); i++) items[i] = static_cast<std::uint32_t>(i);
+        mNodes.reserve(bounds.size() / 3 + 1);
+        mRoot = build(bounds, items.data(), items.data() + items.size());
+    }
+
+    std::int32_t BoundingVolumeHierarchy::build(std::vector<Bounds> const & bounds,
+                                                std::uint32_t * begin, std::uint32_t * end)
+    {
+        // The Root Is Always a Node, so Even a Single Item Gets Tested
+        if (end - begin == 1 && !mNodes.empty()) return ~static_cast<std::int32_t>(* begin);
+
+        // Split at the Median Centroid of the Widest Axis, Twice, for up to Four Children
+        auto split = [&](std::uint32_t * first, std::uint32_t * last) {
+            Bounds extent = { centroid(bounds[* first]), centroid(bounds[* first]) };
+            for (auto i = first; i != last; i++)
+                extent = enclose(extent, Bounds { centroid(bounds[* i]), centroid(bounds[* i]) });
+            glm::vec3 size = extent.max - extent.min;
+            int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+            auto middle = first + (last - first) / 2;
+            std::nth_element(first, middle, last, [&](std::uint32_t a, std::uint32_t b) {
+                return centroid(bounds[a])[axis] < centroid(bounds[b])[axis];
+            });
+            return middle;
+        };
+
+        std::uint32_t * parts[5] = { begin, std::min(begin + 1, end), std::min(begin + 2, end),
+                                     std::min(begin + 3, end), end };
+        if (end - begin > 4)
+        {
+            parts[2] = split(begin, end);
+            parts[1] = split(begin, parts[2]);
+            parts[3] = split(parts[2], end);
+        }
+
+        // Reserve This Node Before Recursing; Children Are Appended After It
+        auto index = static_cast<std::int32_t>(mNodes.size());
+        mNodes.push_back(Node());
+        for (int i = 0; i < 4; i++)
+        {
+            Node & node = mNodes[index];
+            node.minX[i] = node.minY[i] = node.minZ[i] = 0.0f;
+            node.maxX[i] = node.maxY[i] = node.maxZ[i] = 0.0f;
+            node.children[i] = kEmpty;
+            if (parts[i] == parts[i + 1]) continue;
+
+            Bounds box = bounds[* parts[i]];
+            for (auto j = parts[i]; j != parts[i + 1]; j++) box = enclose(box, bounds[* j]);
+            std::int32_t child = build(bounds, parts[i], parts[i + 1]);
+
+            Node & filled = mNodes[index];
+            filled.minX[i] = box.min.x; filled.minY[i] = box.min.y; filled.minZ[i] = box.min.z;
+            filled.maxX[i] = box.max.x; filled.maxY[i] = box.max.y; filled.maxZ[i] = box.max.z;
+            filled.children[i] = child;
+        }   return index;
+    }
+
+    void BoundingVolumeHierarchy::cull(Frustum const & frustum, std::vector<std::uint32_t> & visible) const
+    {
+        if (mNodes.empty()) return;
+
+        // Depth Is Logarithmic in Items, so a Small Fixed Stack Suffices
+        std::int32_t stack[128];
+        int top = 0;
+        stack[top++] = mRoot;
+        while (top > 0)
+        {
+            Node const & node = mNodes[stack[--top]];
+            float const * box[6] = { node.minX, node.minY, node.minZ, node.maxX, node.maxY, node.maxZ };
+            int outside, partial;
+            test(box, frustum, outside, partial);
+            for (int i = 0; i < 4; i++)
+            {
+                std::int32_t child = node.children[i];
+                if (child == kEmpty || (outside & (1 << i))) continue;
+                if (!(partial & (1 << i))) collect(child, visible);
+                else if (child < 0) visible.push_back(static_cast<std::uint32_t>(~child));
+                else stack[top++] = child;
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::collect(std::int32_t child, std::vector<std::uint32_t> & visible) const
+    {
+        // Every Item Below a Fully Visible Box Is Visible
+        if (child < 0) { visible.push_back(static_cast<std::uint32_t>(~child)); return; }
+        for (auto i : mNodes[child].children)
+            if (i != kEmpty) collect(i, visible);
+    }
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+// System Headers
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    struct Vertex;
+
+    // Axis-Aligned Bounding Box
+    struct Bounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Smallest Box Around Vertices, or Around Two Boxes
+    Bounds enclose(Vertex const * vertices, std::size_t count);
+    Bounds enclose(Bounds const & a, Bounds const & b);
+
+    // Six Inward-Facing Planes (Left, Right, Bottom, Top, Near, Far) as ax + by + cz + d
+    struct Frustum {
+        explicit Frustum(glm::mat4 const & matrix);
+        glm::vec4 planes[6];
+    };
+
+    // Four-Wide Hierarchy over Item Bounds; Each Step Tests a Node's Four Children at Once
+    class BoundingVolumeHierarchy
+    {
+    public:
+
+        // Public Member Functions
+        void build(std::vector<Bounds> const & bounds);
+        void cull(Frustum const & frustum, std::vector<std::uint32_t> & visible) const;
+        std::size_t size() const { return mCount; }
+
+    private:
+
+        // Children Are Node Indices, ~Item for Leaves, or kEmpty; Boxes Are Stored SoA
+        struct Node {
+            alignas(16) float minX[4];
+            alignas(16) float minY[4];
+            alignas(16) float minZ[4];
+            alignas(16) float maxX[4];
+            alignas(16) float maxY[4];
+            alignas(16) float maxZ[4];
+            std::int32_t children[4];
+        };
+
+        // Private Member Functions
+        std::int32_t build(std::vector<Bounds> const & bounds, std::uint32_t * begin, std::uint32_t * end);
+        void collect(std::int32_t child, std::vector<std::uint32_t> & visible) const;
+
+        // Private Member Containers
+        std::vector<Node> mNodes;
+
+        // Private Member Variables
+        std::int32_t mRoot  = 0;
+        std::size_t  mCount = 0;
+
+    };
+};
@@ -0,0 +1,5 @@
+// Preprocessor Directives
+#define STB_IMAGE_IMPLEMENTATION
+
+// System Headers
+#include <stb_image.h>
@@ -0,0 +1,80 @@
+// Local Headers
+#include "instances.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cstddef>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Records Packed per Task When Filling the Mapping in Parallel
+        const std::size_t kChunk = 4096;
+    }
+
+    InstanceBuffer::InstanceBuffer(std::size_t capacity)
+        : mStream(new StreamBuffer(GL_ARRAY_BUFFER, std::max<std::size_t>(capacity, 1) * sizeof(Instance)))
+        , mCount(0), mOffset(0)
+    {}
+
+    Instance * InstanceBuffer::map(std::size_t count)
+    {
+        StreamBuffer::reserve(mStream, GL_ARRAY_BUFFER, count * sizeof(Instance));
+        mCount = count;
+        if (count == 0) return nullptr;
+        auto allocation = mStream->allocate(count * sizeof(Instance), sizeof(glm::vec4));
+        mOffset = allocation.offset;
+        return static_cast<Instance *>(allocation.data);
+    }
+
+    void InstanceBuffer::update(Instance const * instances, std::size_t count)
+    {
+        auto mapped = map(count);
+        if (mapped == nullptr) return;
+        std::copy(instances, instances + count, mapped);
+        mStream->flush();
+    }
+
+    void InstanceBuffer::update(glm::mat4 const * transforms, std::size_t count, glm::vec4 const * colors)
+    {
+        // Interleave Straight into the Mapping; Large Updates Are Split Across the Pool
+        auto mapped = map(count);
+        if (mapped == nullptr) return;
+        ThreadPool::global().parallel((count + kChunk - 1) / kChunk, [&](std::size_t chunk) {
+            std::size_t end = std::min(count, (chunk + 1) * kChunk);
+            for (std::size_t i = chunk * kChunk; i < end; i++)
+            {
+                mapped[i].transform = transforms[i];
+                mapped[i].color     = colors ? colors[i] : glm::vec4(1.0f);
+            }
+        });
+        mStream->flush();
+    }
+
+    void InstanceBuffer::attach() const
+    {
+        // A mat4 Attribute Spans Four Consecutive Locations, One Column Each
+        glBindBuffer(GL_ARRAY_BUFFER, mStream->buffer());
+        for (GLuint i = 0; i < 5; i++)
+        {
+            GLvoid const * offset = reinterpret_cast<GLvoid const *>(mOffset + (
+                i < 4 ? offsetof(Instance, transform) + i * sizeof(glm::vec4) : offsetof(Instance, color)));
+            glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), offset);
+            glVertexAttribDivisor(location + i, 1);
+            glEnableVertexAttribArray(location + i);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void InstanceBuffer::detach()
+    {
+        for (GLuint i = 0; i < 5; i++)
+        {
+            glDisableVertexAttribArray(location + i);
+            glVertexAttribDivisor(location + i, 0);
+        }
+    }
+};
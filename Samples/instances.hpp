@@ -0,0 +1,65 @@
+#pragma once
+
+// Local Headers
+#include "stream.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Per-Instance Record; Shaders Read It at Locations 4-7 (Transform) and 8 (Color)
+    struct Instance {
+        glm::mat4 transform;
+        glm::vec4 color;
+    };
+
+    // Streams Per-Instance Records to the GPU Through a Ring, so Updates Only Wait for Draws
+    // Still Reading Earlier Contents When Every Region Is in Flight
+    class InstanceBuffer
+    {
+    public:
+
+        // First Attribute Location Used by Instance Records
+        static const GLuint location = 4;
+
+        // Implement Custom Constructor
+        explicit InstanceBuffer(std::size_t capacity = 1024);
+
+        // Replace the Contents; Colors Default to White
+        void update(Instance const * instances, std::size_t count);
+        void update(glm::mat4 const * transforms, std::size_t count, glm::vec4 const * colors = nullptr);
+        void update(std::vector<Instance> const & instances) { update(instances.data(), instances.size()); }
+
+        // Point Instanced Attributes of the Bound Vertex Array at This Buffer, and Back
+        void attach() const;
+        static void detach();
+
+        // Public Member Functions
+        std::size_t count() const { return mCount; }
+        GLuint buffer() const { return mStream->buffer(); }
+        StreamBuffer::Stats const & stats() const { return mStream->stats(); }
+
+    private:
+
+        // Disable Copying and Assignment
+        InstanceBuffer(InstanceBuffer const &) = delete;
+        InstanceBuffer & operator=(InstanceBuffer const &) = delete;
+
+        // Private Member Functions
+        Instance * map(std::size_t count);
+
+        // Private Member Variables
+        std::unique_ptr<StreamBuffer> mStream;
+        std::size_t mCount;
+        GLintptr mOffset;
+
+    };
+};
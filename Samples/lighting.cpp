@@ -0,0 +1,249 @@
+// Local Headers
+#include "lighting.hpp"
+#include "platform.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Indices Are Sixteen Bits Wide
+        const std::size_t kLights = 65536;
+
+        // Texels per Light: (Position, Range), (Color, Outer Cosine), (Direction, Inner Cosine)
+        const std::size_t kTexels = 3;
+
+        std::size_t align(std::size_t offset) { return (offset + 15) / 16 * 16; }
+
+        // Append Every Light of a Slice Whose Sphere Touches a Box, Testing Four Lights at a Time
+        void gather(Bounds const & box, float const * x, float const * y, float const * z, float const * radius2,
+                    std::uint32_t const * lights, std::size_t count, std::vector<GLushort> & output)
+        {
+        #ifdef MIRAGE_SSE
+            __m128 minX = _mm_set1_ps(box.min.x), minY = _mm_set1_ps(box.min.y), minZ = _mm_set1_ps(box.min.z);
+            __m128 maxX = _mm_set1_ps(box.max.x), maxY = _mm_set1_ps(box.max.y), maxZ = _mm_set1_ps(box.max.z);
+            __m128 zero = _mm_setzero_ps();
+        #endif
+            for (std::size_t i = 0; i < count; i += 4)
+            {
+                // Distance from Each Center to the Box Is Zero Along Axes Where It Lies Inside
+            #ifdef MIRAGE_SSE
+                __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+                __m128 dx = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(minX, px), _mm_sub_ps(px, maxX)));
+                __m128 dy = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(minY, py), _mm_sub_ps(py, maxY)));
+                __m128 dz = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(minZ, pz), _mm_sub_ps(pz, maxZ)));
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                int hits = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_loadu_ps(radius2 + i)));
+            #else
+                int hits = 0;
+                for (int j = 0; j < 4; j++)
+                {
+                    glm::vec3 center(x[i + j], y[i + j], z[i + j]);
+                    glm::vec3 offset = glm::max(glm::vec3(0.0f), glm::max(box.min - center, center - box.max));
+                    if (glm::dot(offset, offset) <= radius2[i + j]) hits |= 1 << j;
+                }
+            #endif
+                for (int j = 0; hits; j++, hits >>= 1)
+                    if (hits & 1) output.push_back(static_cast<GLushort>(lights[i + j]));
+            }
+        }
+    }
+
+    ClusteredLights::ClusteredLights(unsigned int width, unsigned int height, unsigned int depth)
+        : mCounts(std::max(width, 1u) * std::max(height, 1u) * std::max(depth, 1u))
+        , mSlices(std::max(depth, 1u))
+        , mWidth(std::max(width, 1u))
+        , mHeight(std::max(height, 1u))
+        , mDepth(std::max(depth, 1u))
+        , mProjection(0.0f)
+        , mNear(0.0f)
+        , mFar(0.0f)
+        , mBase(0)
+    {
+        mTextures[0] = mTextures[1] = mTextures[2] = 0;
+        mStats.clusters = mCounts.size();
+    }
+
+    ClusteredLights::~ClusteredLights()
+    {
+        if (mTextures[0]) glDeleteTextures(3, mTextures);
+    }
+
+    void ClusteredLights::update(Light const * lights, std::size_t count, glm::mat4 const & view,
+                                 glm::mat4 const & projection, float nearPlane, float farPlane)
+    {
+        auto start = Clock::now();
+        count = std::min(count, kLights);
+        if (projection != mProjection || nearPlane != mNear || farPlane != mFar)
+            frame(projection, nearPlane, farPlane);
+
+        // Slices Grow Geometrically, so Each Light Spans Few of Them Whatever Its Distance
+        for (auto & i : mSlices)
+        {
+            i.x.clear(); i.y.clear(); i.z.clear(); i.radius2.clear();
+            i.lights.clear();
+        }
+        float scale = mDepth / std::log(mFar / mNear);
+        mStats.lights = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            glm::vec3 center(view * glm::vec4(lights[i].position, 1.0f));
+            float radius = lights[i].range, distance = -center.z;
+            if (radius <= 0.0f || distance + radius < mNear || distance - radius > mFar) continue;
+            auto first = distance - radius <= mNear ? 0u
+                       : std::min(mDepth - 1, static_cast<unsigned int>(std::log((distance - radius) / mNear) * scale));
+            auto last  = std::min(mDepth - 1, static_cast<unsigned int>(std::log(std::min(distance + radius, mFar) / mNear) * scale));
+            for (auto s = first; s <= last; s++)
+            {
+                auto & slice = mSlices[s];
+                slice.x.push_back(center.x);
+                slice.y.push_back(center.y);
+                slice.z.push_back(center.z);
+                slice.radius2.push_back(radius * radius);
+                slice.lights.push_back(static_cast<std::uint32_t>(i));
+            }
+            mStats.lights++;
+        }
+
+        // Slices Own Disjoint Clusters, so Each Task Bins One Without Sharing Anything
+        std::size_t tiles = mWidth * mHeight;
+        ThreadPool::global().parallel(mSlices.size(), [&](std::size_t s) {
+            auto & slice = mSlices[s];
+            while (slice.x.size() % 4)
+            {
+                // Padding Has No Reach, so It Never Lands in a Cluster
+                slice.x.push_back(0.0f); slice.y.push_back(0.0f); slice.z.push_back(0.0f);
+                slice.radius2.push_back(-1.0f);
+                slice.lights.push_back(0);
+            }
+            slice.references.clear();
+            for (std::size_t i = s * tiles; i < (s + 1) * tiles; i++)
+            {
+                auto before = slice.references.size();
+                gather(mBoxes[i], slice.x.data(), slice.y.data(), slice.z.data(), slice.radius2.data(),
+                       slice.lights.data(), slice.x.size(), slice.references);
+                mCounts[i] = static_cast<std::uint32_t>(slice.references.size() - before);
+            }
+        });
+        mStats.bin = milliseconds(start);
+
+        // Lights, Then Each Cluster's Offset and Count, Then the Index Lists Back to Back
+        start = Clock::now();
+        mStats.references = 0;
+        for (auto & i : mSlices) mStats.references += i.references.size();
+        std::size_t lightBytes   = align(count * kTexels * sizeof(glm::vec4));
+        std::size_t clusterBytes = align(mCounts.size() * 2 * sizeof(GLuint));
+        std::size_t indexBytes   = align(mStats.references * sizeof(GLushort));
+        if (StreamBuffer::reserve(mStream, GL_TEXTURE_BUFFER, lightBytes + clusterBytes + indexBytes))
+        {
+            // Each View Spans the Whole Ring, so Frames Are Found by Their First Texel
+            const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+            if (mTextures[0] == 0) glGenTextures(3, mTextures);
+            for (int i = 0; i < 3; i++)
+            {
+                glBindTexture(GL_TEXTURE_BUFFER, mTextures[i]);
+                glTexBuffer(GL_TEXTURE_BUFFER, formats[i], mStream->buffer());
+            }
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+        auto allocation = mStream->allocate(lightBytes + clusterBytes + indexBytes, 16);
+        if (allocation.data == nullptr) return;
+
+        auto mapped = static_cast<unsigned char *>(allocation.data);
+        auto texels = reinterpret_cast<glm::vec4 *>(mapped);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto & light = lights[i];
+            float length = glm::length(light.direction);
+            texels[i * kTexels]     = glm::vec4(light.position, light.range);
+            texels[i * kTexels + 1] = glm::vec4(light.color * light.intensity, light.outer);
+            texels[i * kTexels + 2] = glm::vec4(length > 0.0f ? light.direction / length : light.direction, light.inner);
+        }
+
+        auto ranges  = reinterpret_cast<GLuint *>(mapped + lightBytes);
+        auto indices = reinterpret_cast<GLushort *>(mapped + lightBytes + clusterBytes);
+        GLuint offset = 0;
+        mStats.maximum = 0;
+        for (std::size_t i = 0; i < mCounts.size(); i++)
+        {
+            ranges[2 * i]     = offset;
+            ranges[2 * i + 1] = mCounts[i];
+            offset += mCounts[i];
+            mStats.maximum = std::max<std::size_t>(mStats.maximum, mCounts[i]);
+        }
+        for (auto & i : mSlices)
+        {
+            if (i.references.empty()) continue;
+            std::memcpy(indices, i.references.data(), i.references.size() * sizeof(GLushort));
+            indices += i.references.size();
+        }
+        mStream->flush();
+        mBase = glm::ivec3(static_cast<int>(allocation.offset / sizeof(glm::vec4)),
+                           static_cast<int>((allocation.offset + lightBytes) / (2 * sizeof(GLuint))),
+                           static_cast<int>((allocation.offset + lightBytes + clusterBytes) / sizeof(GLushort)));
+        mStats.upload = milliseconds(start);
+    }
+
+    void ClusteredLights::bind(Shader const & shader, GLsizei width, GLsizei height) const
+    {
+        const std::uint32_t samplers[3] = { Shader::hash("lights"), Shader::hash("clusters"), Shader::hash("lightIndices") };
+        for (int i = 0; i < 3; i++)
+        {
+            GLint unit = shader.unit(samplers[i]);
+            if (unit < 0) continue;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_BUFFER, mTextures[i]);
+        }
+
+        // Fragments Find Their Tile from Window Coordinates and Their Slice from View Depth
+        float scale = mDepth / std::log(mFar / mNear);
+        glUniform3i(shader.uniform(Shader::hash("clusterGrid")), mWidth, mHeight, mDepth);
+        glUniform3i(shader.uniform(Shader::hash("clusterBase")), mBase.x, mBase.y, mBase.z);
+        glUniform2f(shader.uniform(Shader::hash("clusterTile")),
+                    mWidth / static_cast<float>(std::max<GLsizei>(width, 1)),
+                    mHeight / static_cast<float>(std::max<GLsizei>(height, 1)));
+        glUniform2f(shader.uniform(Shader::hash("clusterDepth")), scale, -scale * std::log(mNear));
+    }
+
+    void ClusteredLights::frame(glm::mat4 const & projection, float nearPlane, float farPlane)
+    {
+        // Rays Through Each Tile's Corners, Cut at Both Ends of Each Slice, Bound Its Clusters
+        mProjection = projection;
+        mNear = std::max(nearPlane, std::numeric_limits<float>::min());
+        mFar  = std::max(farPlane, mNear * 1.001f);
+        glm::mat4 inverse = glm::inverse(projection);
+        mBoxes.resize(mCounts.size());
+        for (unsigned int s = 0; s < mDepth; s++)
+        {
+            float depths[2] = { mNear * std::pow(mFar / mNear, static_cast<float>(s) / mDepth),
+                                mNear * std::pow(mFar / mNear, static_cast<float>(s + 1) / mDepth) };
+            for (unsigned int y = 0; y < mHeight; y++)
+            for (unsigned int x = 0; x < mWidth; x++)
+            {
+                Bounds box = { glm::vec3( std::numeric_limits<float>::max()),
+                               glm::vec3(-std::numeric_limits<float>::max()) };
+                for (int c = 0; c < 4; c++)
+                {
+                    glm::vec4 corner = inverse * glm::vec4(-1.0f + 2.0f * (x + (c & 1)) / mWidth,
+                                                           -1.0f + 2.0f * (y + (c >> 1)) / mHeight, -1.0f, 1.0f);
+                    glm::vec3 ray = glm::vec3(corner) / corner.w;
+                    for (float d : depths)
+                    {
+                        glm::vec3 point = ray * (d / -ray.z);
+                        box.min = glm::min(box.min, point);
+                        box.max = glm::max(box.max, point);
+                    }
+                }
+                mBoxes[(s * mHeight + y) * mWidth + x] = box;
+            }
+        }
+    }
+};
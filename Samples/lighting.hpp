@@ -0,0 +1,101 @@
+#pragma once
+
+// Local Headers
+#include "culling.hpp"
+#include "shader.hpp"
+#include "stream.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Dynamic Light in World Space; a Point Light Unless Its Cone Is Narrowed
+    struct Light {
+        glm::vec3 position;
+        float     range     = 10.0f; // Distance Where the Light Fades to Nothing
+        glm::vec3 color     = glm::vec3(1.0f);
+        float     intensity = 1.0f;
+        glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+        float     inner     = -1.0f; // Cosines of the Cone's Half-Angles: Full Light Inside
+        float     outer     = -1.0f; // inner, None Outside outer; -1 Lights Every Direction
+    };
+
+    // Slices the View Frustum into a Grid of Clusters, Tiles on Screen and Geometric Slices in
+    // Depth, and Lists the Lights Reaching Each One; Lit Shaders Loop Only Over Their Cluster's
+    class ClusteredLights
+    {
+    public:
+
+        // Work Done by the Last update()
+        struct Stats {
+            std::size_t lights     = 0;   // Reaching at Least One Slice
+            std::size_t clusters   = 0;
+            std::size_t references = 0;   // Light Indices Uploaded
+            std::size_t maximum    = 0;   // Most Lights in One Cluster
+            double      bin        = 0.0; // Milliseconds
+            double      upload     = 0.0;
+        };
+
+        // Implement Custom Constructor and Destructor
+         ClusteredLights(unsigned int width = 16, unsigned int height = 9, unsigned int depth = 24);
+        ~ClusteredLights();
+
+        // Bin Lights Against a Perspective Camera, Slicing Depth Between Two Distances, and Stream
+        // the Lights, Cluster Ranges and Index Lists; Only the First 65536 Lights Are Used
+        void update(Light const * lights, std::size_t count, glm::mat4 const & view,
+                    glm::mat4 const & projection, float nearPlane, float farPlane);
+        void update(std::vector<Light> const & lights, glm::mat4 const & view,
+                    glm::mat4 const & projection, float nearPlane, float farPlane)
+        { update(lights.data(), lights.size(), view, projection, nearPlane, farPlane); }
+
+        // Point the Active Shader's Light Buffers and Grid Uniforms at the Last update()
+        void bind(Shader const & shader, GLsizei width, GLsizei height) const;
+
+        // Public Member Functions
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        ClusteredLights(ClusteredLights const &) = delete;
+        ClusteredLights & operator=(ClusteredLights const &) = delete;
+
+        // View-Space Spheres of the Lights Reaching One Depth Slice, Padded to Groups of Four,
+        // and the Indices Its Clusters Collected, Cluster After Cluster
+        struct Slice {
+            std::vector<float> x, y, z, radius2;
+            std::vector<std::uint32_t> lights;
+            std::vector<GLushort> references;
+        };
+
+        // Private Member Functions
+        void frame(glm::mat4 const & projection, float nearPlane, float farPlane);
+
+        // Private Member Containers
+        std::vector<Bounds> mBoxes;          // View-Space Bounds of Each Cluster
+        std::vector<std::uint32_t> mCounts;  // Lights in Each Cluster
+        std::vector<Slice> mSlices;
+
+        // Private Member Variables
+        unsigned int mWidth;
+        unsigned int mHeight;
+        unsigned int mDepth;
+        glm::mat4 mProjection;
+        float mNear;
+        float mFar;
+        glm::ivec3 mBase;    // First Light, Cluster and Index Texel of the Last update()
+        std::unique_ptr<StreamBuffer> mStream;
+        GLuint mTextures[3]; // Lights as RGBA32F, Cluster Ranges as RG32UI, Indices as R16UI
+        Stats mStats;
+
+    };
+};
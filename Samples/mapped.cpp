@@ -0,0 +1,57 @@
+// Local Headers
+#include "mapped.hpp"
+
+// System Headers
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Define Namespace
+namespace Mirage
+{
+    MappedFile::MappedFile(std::string const & filename)
+        : mData(nullptr), mSize(0), mHandle(nullptr)
+    {
+    #ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size; GetFileSizeEx(file, & size);
+        HANDLE mapping = size.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (mapping == nullptr) return;
+        mData = static_cast<unsigned char const *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        mSize = static_cast<std::size_t>(size.QuadPart);
+        mHandle = mapping;
+    #else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, & info) == 0 && info.st_size > 0)
+        {
+            void * data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                mData = static_cast<unsigned char const *>(data);
+                mSize = static_cast<std::size_t>(info.st_size);
+            }
+        }   close(fd);
+    #endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+    #ifdef _WIN32
+        if (mData)   UnmapViewOfFile(mData);
+        if (mHandle) CloseHandle(mHandle);
+    #else
+        if (mData) munmap(const_cast<unsigned char *>(mData), mSize);
+    #endif
+    }
+};
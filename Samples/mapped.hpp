@@ -0,0 +1,36 @@
+#pragma once
+
+// Standard Headers
+#include <cstddef>
+#include <string>
+
+// Define Namespace
+namespace Mirage
+{
+    // Read-Only View of a File Mapped into Memory
+    class MappedFile
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+         MappedFile(std::string const & filename);
+        ~MappedFile();
+
+        // Public Member Functions
+        unsigned char const * data() const { return mData; }
+        std::size_t size() const { return mSize; }
+        bool valid() const { return mData != nullptr; }
+
+    private:
+
+        // Disable Copying and Assignment
+        MappedFile(MappedFile const &) = delete;
+        MappedFile & operator=(MappedFile const &) = delete;
+
+        // Private Member Variables
+        unsigned char const * mData;
+        std::size_t mSize;
+        void * mHandle;
+
+    };
+};
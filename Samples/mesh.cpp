@@ -1,63 +1,336 @@
-// Preprocessor Directives
-#define STB_IMAGE_IMPLEMENTATION
-
 // Local Headers
+#include "animation.hpp"
+#include "cache.hpp"
 #include "mesh.hpp"
+#include "occlusion.hpp"
+#include "optimize.hpp"
+#include "quantize.hpp"
+#include "simplify.hpp"
+#include "texture.hpp"
+#include "threadpool.hpp"
 
-// System Headers
-#include <stb_image.h>
+// Standard Headers
+#include <algorithm>
+#include <cmath>
 
 // Define Namespace
 namespace Mirage
 {
-    Mesh::Mesh(std::string const & filename) : Mesh()
-    {
-        // Load a Model from File
-        Assimp::Importer loader;
-        aiScene const * scene = loader.ReadFile(
-            PROJECT_SOURCE_DIR "/Mirage/Models/" + filename,
-            aiProcessPreset_TargetRealtime_MaxQuality |
-            aiProcess_OptimizeGraph                   |
-            aiProcess_FlipUVs);
-
-        // Walk the Tree of Scene Nodes
-        auto index = filename.find_last_of("/");
-        if (!scene) fprintf(stderr, "%s\n", loader.GetErrorString());
-        else parse(filename.substr(0, index), scene->mRootNode, scene);
-    }
-
-    Mesh::Mesh(std::vector<Vertex> const & vertices,
-               std::vector<GLuint> const & indices,
-               std::map<GLuint, std::string> const & textures)
-                    : mIndices(indices)
-                    , mVertices(vertices)
+    namespace
+    {
+        // Queue a Texture Binding for a Command, Folding It into the Command's Material Hash
+        void enqueue(RenderQueue & queue, RenderCommand & command, std::uint32_t & hash,
+                     GLint unit, GLenum target, GLuint texture)
+        {
+            if (unit < 0) return;
+            TextureBinding binding = { static_cast<GLuint>(unit), target, texture };
+            queue.material(& binding, 1);
+            command.textures++;
+            hash = (hash ^ texture) * 16777619u;
+        }
+
+        // Assimp Matrices Are Row-Major; glm Stores Columns
+        glm::mat4 convert(aiMatrix4x4 const & m)
+        {
+            return glm::mat4(glm::vec4(m.a1, m.b1, m.c1, m.d1), glm::vec4(m.a2, m.b2, m.c2, m.d2),
+                             glm::vec4(m.a3, m.b3, m.c3, m.d3), glm::vec4(m.a4, m.b4, m.c4, m.d4));
+        }
+
+        // Box Around a Transformed Box, from Its Center and Absolute Extents
+        Bounds enclose(Bounds const & bounds, glm::mat4 const & transform)
+        {
+            glm::vec3 center = (bounds.min + bounds.max) * 0.5f, extent = (bounds.max - bounds.min) * 0.5f, reach;
+            for (int i = 0; i < 3; i++)
+                reach[i] = std::fabs(transform[0][i]) * extent.x + std::fabs(transform[1][i]) * extent.y
+                         + std::fabs(transform[2][i]) * extent.z;
+            center = glm::vec3(transform * glm::vec4(center, 1.0f));
+            Bounds result = { center - reach, center + reach };
+            return result;
+        }
+
+        const glm::mat4 kIdentity(1.0f);
+
+        // Counted by Mesh::beginFrame(); Command Rings Advance When It Changes
+        std::uint64_t & frames() { static std::uint64_t frame = 0; return frame; }
+
+        // Map a Freshly Specified Buffer for Writing; Empty Buffers Cannot Be Mapped
+        template<typename T>
+        T * map(GLenum target, std::size_t count)
+        {
+            if (count == 0) return nullptr;
+            return static_cast<T *>(glMapBufferRange(target, 0, count * sizeof(T),
+                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        }
+
+        // Fill a Freshly Specified Buffer Through a Mapping; Should Mapping Fail or the Contents Be
+        // Lost on Unmap, Fill Client Memory Instead and Respecify the Buffer from That
+        template<typename T, typename Writer>
+        void fill(GLenum target, std::size_t count, Writer write)
+        {
+            if (count == 0) return;
+            if (auto mapped = map<T>(target, count))
+            {
+                write(mapped);
+                if (glUnmapBuffer(target) == GL_TRUE) return;
+            }
+            std::vector<T> staging(count);
+            write(staging.data());
+            glBufferData(target, count * sizeof(T), staging.data(), GL_STATIC_DRAW);
+        }
+
+        template<typename T>
+        std::size_t bytes(std::vector<T> const & vector) { return vector.capacity() * sizeof(T); }
+    }
+
+    struct Mesh::Import {
+        ImportOptions options;
+        std::string path;
+        TextureLoader loader;
+        std::vector<MeshCache::Entry> entries;
+        std::vector<std::multimap<GLuint, std::string>> textures;
+        std::vector<MeshCache::Node> nodes;
+
+        // Bone Influences per Entry; Empty for Rigid Sub-Meshes
+        std::vector<std::vector<VertexWeights>> weights;
+
+        // Owned Storage Behind the Entries When Importing Through Assimp
+        std::vector<std::vector<Vertex>> vertices;
+        std::vector<std::vector<GLuint>> indices;
+
+        // Vertices Moved into Model Space by flatten()
+        std::vector<std::vector<Vertex>> placed;
+
+        // Note the Staged Geometry Plus Anything Else Held Right Now, Keeping the Largest Total
+        std::size_t peak = 0;
+        void measure(std::size_t held = 0)
+        {
+            for (auto & i : vertices) held += bytes(i);
+            for (auto & i : indices)  held += bytes(i);
+            for (auto & i : placed)   held += bytes(i);
+            for (auto & i : weights)  held += bytes(i);
+            peak = std::max(peak, held);
+        }
+
+        // Free One Entry's Staging Once Nothing Reads It Again
+        void release(std::size_t entry)
+        {
+            if (entry < vertices.size()) std::vector<Vertex>().swap(vertices[entry]);
+            if (entry < indices.size())  std::vector<GLuint>().swap(indices[entry]);
+            if (entry < placed.size())   std::vector<Vertex>().swap(placed[entry]);
+            if (entry < weights.size())  std::vector<VertexWeights>().swap(weights[entry]);
+        }
+    };
+
+    Mesh::Mesh(std::string const & filename, ImportOptions const & options) : Mesh()
+    {
+        // Reuse Previously Imported Geometry When the Cache Is Current
+        std::string source = PROJECT_SOURCE_DIR "/Mirage/Models/" + filename;
+        unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality |
+                             aiProcess_OptimizeGraph                   |
+                             aiProcess_FlipUVs;
+        Import import;
+        import.options = options;
+        import.path = filename.substr(0, filename.find_last_of("/"));
+        std::string variant = options.optimize ? ".opt" : "";
+        if (options.lods) variant += ".lod" + std::to_string(options.lods);
+        MeshCache cache(source, flags, variant);
+        if (cache.read(import.entries, import.nodes))
+        {
+            for (auto & i : import.entries)
+                import.textures.push_back(process(import.path, i.textures, import.loader));
+        }
+        else
+        {
+            // Load a Model from File
+            Assimp::Importer loader;
+            aiScene const * scene = loader.ReadFile(source, flags);
+
+            // Animated Models Keep Every Node as a Joint, in the Same Order parse() Records Nodes
+            if (!scene) { fprintf(stderr, "%s\n", loader.GetErrorString()); return; }
+            bool animated = scene->mNumAnimations > 0;
+            for (unsigned int i = 0; i < scene->mNumMeshes; i++) animated |= scene->mMeshes[i]->HasBones();
+            if (animated) mSkeleton.reset(new Skeleton(scene));
+
+            // Walk the Tree of Scene Nodes While Textures Decode in the Background, Then Drop the
+            // Scene, Whose Geometry Has Been Copied Out
+            parse(scene->mRootNode, scene, import, SceneGraph::none);
+            aiMemoryInfo memory;
+            loader.GetMemoryRequirements(memory);
+            import.measure(memory.total);
+            loader.FreeScene();
+
+            // Reordering or Decimating Would Leave Bone Weights Behind, so Animated Models Skip Both
+            if (options.optimize && !animated) optimize(filename, import);
+            if (options.lods && !animated) decimate(filename, import);
+            import.measure();
+
+            // Store the Processed Geometry for Subsequent Runs; Skeletons and Clips Live in the
+            // Source Scene, so Animated Models Are Imported Afresh Each Time
+            if (!animated) cache.write(import.entries, import.nodes);
+        }
+        import.weights.resize(import.entries.size());
+
+        // Rebuild the Node Hierarchy Breadth-First and Resolve Every Node's World Transform;
+        // Import Order Still Names Each Sub-Mesh's Joint
+        for (auto & i : import.nodes) mScene.add(i.parent, i.transform);
+        auto remap = mScene.build();
+        std::vector<std::uint32_t> joints;
+        for (auto & i : import.entries) { joints.push_back(i.node); i.node = remap[i.node]; }
+        mScene.update();
+
+        // Upload Either One Buffer per Sub-Mesh, Drawn at Its Node, or a Single Merged Buffer;
+        // Animated Sub-Meshes Are Posed One by One, So They Are Neither Merged Nor Quantized
+        if (options.merge && !mSkeleton) merge(import);
+        else for (std::size_t i = 0; i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            bool skinned = !import.weights[i].empty();
+            mSubMeshes.push_back(std::unique_ptr<Mesh>(skinned
+                ? new Mesh(entry.vertices, entry.vertexCount, entry.indices, entry.indexCount,
+                           import.weights[i].data(), mSkeleton, import.textures[i])
+                : new Mesh(entry.vertices, entry.vertexCount, entry.indices, entry.indexCount,
+                           import.textures[i], options.quantize && !mSkeleton)));
+            if (!options.keep) import.release(i);
+            auto & mesh = mSubMeshes.back();
+            mesh->mGraph = skinned ? nullptr : & mScene;
+            mesh->mNode  = entry.node;
+            mesh->mJoint = joints[i];
+            mBounds.push_back(enclose(mesh->mBounds.front(), mesh->transform()));
+            if (entry.levels.empty()) continue;
+            Chain chain = { 0, static_cast<std::uint32_t>(entry.levels.size()), 0 };
+            mesh->mLevels = entry.levels;
+            mesh->mChains.assign(1, chain);
+        }   mHierarchy.build(mBounds);
+
+        // Keep a Single Copy of All Sub-Meshes in Model Space, Indices Rebased, if Requested
+        if (options.keep && (!options.merge || mSkeleton)) flatten(import);
+        std::size_t vertexCount = 0, indexCount = 0;
+        for (std::size_t i = 0; options.keep && i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            vertexCount += entry.vertexCount;
+            indexCount  += entry.levels.empty() ? entry.indexCount : entry.levels.front().count;
+        }
+        mVertices.reserve(vertexCount);
+        mIndices.reserve(indexCount);
+        for (std::size_t i = 0; options.keep && i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            auto base  = static_cast<GLuint>(mVertices.size());
+            auto count = entry.levels.empty() ? entry.indexCount : entry.levels.front().count;
+            mVertices.insert(mVertices.end(), entry.vertices, entry.vertices + entry.vertexCount);
+            for (std::uint32_t j = 0; j < count; j++) mIndices.push_back(base + entry.indices[j]);
+        }
+
+        // Staging Is Freed Before Waiting on Textures; Whatever Parts Hold Is Kept for Good
+        for (auto & i : import.entries)
+            mImported.geometry += i.vertexCount * sizeof(Vertex) + i.indexCount * sizeof(GLuint);
+        mImported.kept = bytes(mVertices) + bytes(mIndices);
+        for (auto & i : mSubMeshes) mImported.kept += bytes(i->mBindPose) + bytes(i->mWeights);
+        import.measure(mImported.kept);
+        for (std::size_t i = 0; i < import.entries.size(); i++) import.release(i);
+        mImported.peak = import.peak;
+        fprintf(stderr, "%s: %.1f MB geometry, %.1f MB peak while importing, %.1f MB kept\n", filename.c_str(),
+                mImported.geometry / 1048576.0, mImported.peak / 1048576.0, mImported.kept / 1048576.0);
+        finish(filename, import.loader);
+    }
+
+    Mesh::Mesh(std::vector<Vertex> vertices,
+               std::vector<GLuint> indices,
+               std::multimap<GLuint, std::string> const & textures,
+               bool keep)
+                    : mIndices(std::move(indices))
+                    , mVertices(std::move(vertices))
                     , mTextures(textures)
+                    , mSamplers(samplers(textures))
+    {
+        upload(mVertices.data(), mVertices.size(), mIndices.data(), mIndices.size(), false);
+        if (keep) return;
+        std::vector<Vertex>().swap(mVertices);
+        std::vector<GLuint>().swap(mIndices);
+    }
+
+    Mesh::Mesh(Vertex const * vertices, std::size_t vertexCount,
+               GLuint const * indices,  std::size_t indexCount,
+               std::multimap<GLuint, std::string> const & textures,
+               bool quantize)
+                    : mTextures(textures)
+                    , mSamplers(samplers(textures))
+    {
+        upload(vertices, vertexCount, indices, indexCount, quantize);
+    }
+
+    Mesh::Mesh(Vertex const * vertices, std::size_t vertexCount,
+               GLuint const * indices,  std::size_t indexCount,
+               VertexWeights const * weights, std::shared_ptr<Skeleton> const & skeleton,
+               std::multimap<GLuint, std::string> const & textures)
+                    : mTextures(textures)
+                    , mSamplers(samplers(textures))
+                    , mBindPose(vertices, vertices + vertexCount)
+                    , mWeights(weights, weights + vertexCount)
+                    , mSkeleton(skeleton)
+    {
+        upload(vertices, vertexCount, indices, indexCount, false);
+    }
+
+    Mesh::~Mesh()
+    {
+        glDeleteVertexArrays(1, & mVertexArray);
+        glDeleteVertexArrays(1, & mSkinnedArray);
+        glDeleteBuffers(1, & mIndirectBuffer);
+        glDeleteBuffers(1, & mMaterialBuffer);
+        glDeleteTextures(1, & mMaterialTexture);
+        for (auto & i : mTextures) TextureRegistry::global().release(i.first);
+        for (auto & i : mBatches)
+        for (auto & j : i.textures) TextureRegistry::global().release(j.first);
+    }
+
+    void Mesh::upload(Vertex const * vertices, std::size_t vertexCount,
+                      GLuint const * indices,  std::size_t indexCount, bool quantize)
     {
         // Bind a Vertex Array Object
+        mBounds.assign(1, enclose(vertices, vertexCount));
+        mHierarchy.build(mBounds);
+        mIndexCount = static_cast<GLsizei>(indexCount);
+        mIndexType  = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        mQuantized  = quantize;
         glGenVertexArrays(1, & mVertexArray);
         glBindVertexArray(mVertexArray);
 
-        // Copy Vertex Buffer Data
+        // Copy Vertex Buffer Data, Packing It Straight into the Mapping if Requested
         glGenBuffers(1, & mVertexBuffer);
         glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER,
-                     mVertices.size() * sizeof(Vertex),
-                   & mVertices.front(), GL_STATIC_DRAW);
+        if (quantize)
+        {
+            auto quantization = bounds(vertices, vertexCount);
+            mPositionOffset = quantization.offset;
+            mPositionScale  = quantization.scale;
+            glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(PackedVertex), nullptr, GL_STATIC_DRAW);
+            fill<PackedVertex>(GL_ARRAY_BUFFER, vertexCount, [&](PackedVertex * packed) {
+                encode(vertices, vertexCount, quantization, packed);
+            });
+        }
+        else glBufferData(GL_ARRAY_BUFFER,
+                          vertexCount * sizeof(Vertex),
+                          vertices, GL_STATIC_DRAW);
 
-        // Copy Index Buffer Data
+        // Copy Index Buffer Data, Narrowed to 16 Bits in the Mapping When Every Index Fits
         glGenBuffers(1, & mElementBuffer);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     mIndices.size() * sizeof(GLuint),
-                   & mIndices.front(), GL_STATIC_DRAW);
+        if (mIndexType == GL_UNSIGNED_SHORT)
+        {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLushort), nullptr, GL_STATIC_DRAW);
+            fill<GLushort>(GL_ELEMENT_ARRAY_BUFFER, indexCount, [&](GLushort * narrow) {
+                std::copy(indices, indices + indexCount, narrow);
+            });
+        }
+        else glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                          indexCount * sizeof(GLuint),
+                          indices, GL_STATIC_DRAW);
 
         // Set Shader Attributes
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, position));
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, normal));
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, uv));
-        glEnableVertexAttribArray(0); // Vertex Positions
-        glEnableVertexAttribArray(1); // Vertex Normals
-        glEnableVertexAttribArray(2); // Vertex UVs
+        attributes(quantize);
+        if (!mWeights.empty()) skin();
 
         // Cleanup Buffers
         glBindVertexArray(0);
@@ -65,105 +338,888 @@ namespace Mirage
         glDeleteBuffers(1, & mElementBuffer);
     }
 
-    void Mesh::draw(GLuint shader)
+    void Mesh::skin()
     {
-        unsigned int unit = 0, diffuse = 0, specular = 0;
-        for (auto &i : mSubMeshes) i->draw(shader);
-        for (auto &i : mTextures)
+        // Bone Influences Sit in a Buffer of Their Own, Read Only by Shaders That Skin
+        GLuint buffer;
+        glGenBuffers(1, & buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, mWeights.size() * sizeof(VertexWeights), mWeights.data(), GL_STATIC_DRAW);
+        glVertexAttribIPointer(9, 4, GL_UNSIGNED_SHORT, sizeof(VertexWeights), (GLvoid *) offsetof(VertexWeights, bones));
+        glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(VertexWeights), (GLvoid *) offsetof(VertexWeights, weights));
+        glEnableVertexAttribArray(9);  // Bone Indices
+        glEnableVertexAttribArray(10); // Bone Weights
+        glDeleteBuffers(1, & buffer);
+
+        // Skinning on the CPU Streams Whole Vertices, so This Array Shares Only the Indices
+        glGenVertexArrays(1, & mSkinnedArray);
+        glBindVertexArray(mSkinnedArray);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
+        glBindVertexArray(mVertexArray);
+    }
+
+    void Mesh::flatten(Import & import)
+    {
+        // Bake Each Node's Transform into Its Sub-Mesh; Normals Take the Inverse Transpose
+        import.placed.resize(import.entries.size());
+        for (std::size_t i = 0; i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            auto & world = mScene.world(entry.node);
+            if (world == kIdentity || !import.weights[i].empty()) continue;
+            glm::mat3 normals = glm::transpose(glm::inverse(glm::mat3(world)));
+            auto & placed = import.placed[i];
+            placed.assign(entry.vertices, entry.vertices + entry.vertexCount);
+            for (auto & j : placed)
+            {
+                j.position = glm::vec3(world * glm::vec4(j.position, 1.0f));
+                j.normal   = glm::normalize(normals * j.normal);
+            }   entry.vertices = placed.data();
+        }
+    }
+
+    void Mesh::merge(Import & import)
+    {
+        if (import.entries.empty()) return;
+
+        // Every Draw Shares the Caller's Model Matrix, so Node Transforms Are Baked In
+        flatten(import);
+
+        // Group Sub-Meshes by Texture Set, so Each Group Is One Multi-Draw
+        std::map<std::multimap<GLuint, std::string>, std::vector<std::size_t>> groups;
+        for (std::size_t i = 0; i < import.entries.size(); i++)
+        {
+            auto inserted = groups.insert(std::make_pair(import.textures[i], std::vector<std::size_t>()));
+            inserted.first->second.push_back(i);
+            if (!inserted.second) // The Group Already Holds a Reference
+                for (auto & j : import.textures[i]) TextureRegistry::global().release(j.first);
+        }
+
+        // Indices Are Local to Each Sub-Mesh, so 16 Bits Suffice if Every Sub-Mesh Fits
+        bool quantize = import.options.quantize;
+        mQuantized = quantize;
+        mIndexType = GL_UNSIGNED_SHORT;
+        for (auto & i : import.entries) if (i.vertexCount > 65536) mIndexType = GL_UNSIGNED_INT;
+        std::size_t indexSize  = mIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        std::size_t vertexSize = quantize ? sizeof(PackedVertex) : sizeof(Vertex);
+
+        // Lay Out Commands with Base-Vertex Offsets into the Shared Buffers
+        std::size_t vertexCount = 0, indexCount = 0;
+        std::vector<glm::uvec4> materials;
+        for (auto & group : groups)
+        {
+            Batch batch = { group.first, samplers(group.first), static_cast<GLsizei>(mDraws.commands.size()),
+                            static_cast<GLsizei>(group.second.size()) };
+            GLuint diffuse = 0, specular = 0;
+            for (auto & i : group.first) (i.second == "diffuse" ? diffuse : specular)++;
+            for (auto i : group.second)
+            {
+                // Every Draw Gets a Chain, Even if It Is Just the Full Mesh; Draws Start at Level 0
+                auto & entry = import.entries[i];
+                Chain chain = { static_cast<std::uint32_t>(mLevels.size()), 1, 0 };
+                if (entry.levels.empty()) mLevels.push_back(LevelOfDetail { 0, entry.indexCount, 0.0f });
+                else mLevels.insert(mLevels.end(), entry.levels.begin(), entry.levels.end());
+                chain.count = static_cast<std::uint32_t>(mLevels.size()) - chain.first;
+                for (auto j = chain.first; j < chain.first + chain.count; j++)
+                    mLevels[j].first += static_cast<std::uint32_t>(indexCount);
+                mChains.push_back(chain);
+
+                DrawCommand command = { mLevels[chain.first].count, 1,
+                                        static_cast<GLuint>(indexCount),
+                                        static_cast<GLint>(vertexCount),
+                                        static_cast<GLuint>(mDraws.commands.size()) };
+                mDraws.push(command, indexSize);
+                mBounds.push_back(enclose(entry.vertices, entry.vertexCount));
+                materials.push_back(glm::uvec4(static_cast<GLuint>(mBatches.size()), diffuse, specular, i));
+                vertexCount += entry.vertexCount;
+                indexCount  += entry.indexCount;
+            }   mBatches.push_back(batch);
+        }
+
+        // Merged Draws Share One Dequantization Transform Spanning the Whole Model
+        Quantization quantization = bounds(nullptr, 0);
+        for (std::size_t i = 0; quantize && i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            auto local = bounds(entry.vertices, entry.vertexCount);
+            quantization = i == 0 ? local : bounds(quantization, local);
+        }   mPositionOffset = quantization.offset;
+            mPositionScale  = quantization.scale;
+
+        // Copy Every Sub-Mesh into One Vertex and One Index Buffer
+        glBindVertexArray(mVertexArray);
+        glGenBuffers(1, & mVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * vertexSize, nullptr, GL_STATIC_DRAW);
+        glGenBuffers(1, & mElementBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, nullptr, GL_STATIC_DRAW);
+        fill<unsigned char>(GL_ARRAY_BUFFER, vertexCount * vertexSize, [&](unsigned char * vertices) {
+            for (auto & i : mDraws.commands)
+            {
+                auto & entry = import.entries[materials[i.baseInstance].w];
+                auto vertex = vertices + i.baseVertex * vertexSize;
+                if (quantize) encode(entry.vertices, entry.vertexCount, quantization,
+                                     reinterpret_cast<PackedVertex *>(vertex));
+                else std::copy(entry.vertices, entry.vertices + entry.vertexCount,
+                               reinterpret_cast<Vertex *>(vertex));
+            }
+        });
+        fill<unsigned char>(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, [&](unsigned char * indices) {
+            for (auto & i : mDraws.commands)
+            {
+                auto & entry = import.entries[materials[i.baseInstance].w];
+                auto index = indices + i.firstIndex * indexSize;
+                if (mIndexType == GL_UNSIGNED_SHORT)
+                     std::copy(entry.indices, entry.indices + entry.indexCount, reinterpret_cast<GLushort *>(index));
+                else std::copy(entry.indices, entry.indices + entry.indexCount, reinterpret_cast<GLuint *>(index));
+            }
+        });
+        attributes(quantize);
+
+        // Expose the Draw Index as a Per-Instance Attribute; baseInstance Selects It
+        std::vector<GLuint> draws(mDraws.commands.size());
+        for (std::size_t i = 0; i < draws.size(); i++) draws[i] = static_cast<GLuint>(i);
+        GLuint drawBuffer;
+        glGenBuffers(1, & drawBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, drawBuffer);
+        glBufferData(GL_ARRAY_BUFFER, draws.size() * sizeof(GLuint), draws.data(), GL_STATIC_DRAW);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(3); // Draw Index
+        glBindVertexArray(0);
+        glDeleteBuffers(1, & mVertexBuffer);
+        glDeleteBuffers(1, & mElementBuffer);
+        glDeleteBuffers(1, & drawBuffer);
+
+        // Per-Draw Material Records (Batch, Diffuse Count, Specular Count, Sub-Mesh)
+        glGenBuffers(1, & mMaterialBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, mMaterialBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, materials.size() * sizeof(glm::uvec4), materials.data(), GL_STATIC_DRAW);
+        glGenTextures(1, & mMaterialTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, mMaterialTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, mMaterialBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        // Indirect Commands Live on the GPU When Multi-Draw Indirect Is Available. A Region of the
+        // Ring Starts Sized for One Draw's Survivors and Grows When a Frame Draws the Mesh More.
+        // Attribute 3 Needs baseInstance, Which Must Be Zero Without Base Instance Support, so
+        // Such Drivers Stay on the Per-Draw Path
+        bool baseInstance = GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance;
+        if ((GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_multi_draw_indirect) && baseInstance)
+        {
+            std::size_t size = mDraws.commands.size() * sizeof(DrawCommand);
+            glGenBuffers(1, & mIndirectBuffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, size, mDraws.commands.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            mCommands.reset(new StreamBuffer(GL_DRAW_INDIRECT_BUFFER, size));
+        }
+    }
+
+    void Mesh::DrawList::push(DrawCommand const & command, std::size_t indexSize)
+    {
+        commands.push_back(command);
+        counts.push_back(static_cast<GLsizei>(command.count));
+        offsets.push_back(reinterpret_cast<GLvoid const *>(command.firstIndex * indexSize));
+        baseVertices.push_back(command.baseVertex);
+    }
+
+    void Mesh::DrawList::clear()
+    {
+        commands.clear();
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+    }
+
+    void Mesh::attributes(bool quantized, GLintptr offset)
+    {
+        if (quantized)
+        {
+            GLsizei stride = sizeof(PackedVertex);
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (GLvoid *) offsetof(PackedVertex, position));
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (GLvoid *) offsetof(PackedVertex, normal));
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (GLvoid *) offsetof(PackedVertex, uv));
+        }
+        else
+        {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (offset + offsetof(Vertex, position)));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (offset + offsetof(Vertex, normal)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (offset + offsetof(Vertex, uv)));
+        }
+        glEnableVertexAttribArray(0); // Vertex Positions
+        glEnableVertexAttribArray(1); // Vertex Normals
+        glEnableVertexAttribArray(2); // Vertex UVs
+    }
+
+    void Mesh::dequantize(Shader const & shader) const
+    {
+        // Quantized Positions Are in [0, 1]; Shaders Compute offset + scale * position
+        if (!mQuantized) return;
+        GLint offset = shader.uniform(Shader::hash("positionOffset"));
+        GLint scale  = shader.uniform(Shader::hash("positionScale"));
+        if (offset >= 0) shader.bind(offset, mPositionOffset);
+        if (scale  >= 0) shader.bind(scale,  mPositionScale);
+    }
+
+    void Mesh::place(Shader const & shader) const
+    {
+        // Sub-Meshes Sit at Their Node; Everything Else Is Already in Model Space
+        GLint node = shader.uniform(Shader::hash("node"));
+        if (node >= 0) shader.bind(node, transform());
+    }
+
+    glm::mat4 const & Mesh::transform() const
+    {
+        return mGraph ? mGraph->world(mNode) : kIdentity;
+    }
+
+    void Mesh::update()
+    {
+        // Merged Models Baked Their Nodes at Import; Others Refit Their Bounds to the Moved Nodes
+        if (mScene.update() == 0 || !mBatches.empty()) return;
+        for (std::size_t i = 0; i < mSubMeshes.size(); i++)
+            mBounds[i] = enclose(mSubMeshes[i]->mBounds.front(), mSubMeshes[i]->transform());
+        mHierarchy.build(mBounds);
+    }
+
+    std::vector<std::pair<GLuint, std::uint32_t>> Mesh::samplers(std::multimap<GLuint, std::string> const & textures)
+    {
+        std::vector<std::pair<GLuint, std::uint32_t>> samplers;
+        unsigned int diffuse = 0, specular = 0;
+        for (auto &i : textures)
         {   // Set Correct Uniform Names Using Texture Type (Omit ID for 0th Texture)
             std::string uniform = i.second;
                  if (i.second == "diffuse")  uniform += (diffuse++  > 0) ? std::to_string(diffuse)  : "";
             else if (i.second == "specular") uniform += (specular++ > 0) ? std::to_string(specular) : "";
+            samplers.push_back(std::make_pair(i.first, Shader::hash(uniform.c_str())));
+        }   return samplers;
+    }
 
-            // Bind Correct Textures and Vertex Array Before Drawing
+    void Mesh::bind(Shader const & shader, std::vector<std::pair<GLuint, std::uint32_t>> const & samplers)
+    {
+        // Samplers Already Point at Fixed Units, so Only Texture Binds Remain
+        for (auto &i : samplers)
+        {
+            GLint unit = shader.unit(i.second);
+            if (unit < 0) continue;
             glActiveTexture(GL_TEXTURE0 + unit);
             glBindTexture(GL_TEXTURE_2D, i.first);
-            glUniform1f(glGetUniformLocation(shader, uniform.c_str()), ++unit);
-        }   glBindVertexArray(mVertexArray);
-            glDrawElements(GL_TRIANGLES, mIndices.size(), GL_UNSIGNED_INT, 0);
+        }
     }
 
-    void Mesh::parse(std::string const & path, aiNode const * node, aiScene const * scene)
+    void Mesh::draw(Shader const & shader)
     {
+        submit(shader, nullptr);
+    }
+
+    void Mesh::draw(Shader const & shader, Frustum const & frustum)
+    {
+        // Frustum Planes Are in This Mesh's Model Space; Sorting Keeps Batches Contiguous
+        mVisible.clear();
+        mHierarchy.cull(frustum, mVisible);
+        std::sort(mVisible.begin(), mVisible.end());
+        stats().visible += mVisible.size();
+        stats().culled  += mBounds.size() - mVisible.size();
+        submit(shader, & mVisible);
+    }
+
+    void Mesh::draw(Shader const & shader, OcclusionCuller & occlusion, glm::mat4 const & model)
+    {
+        // Frustum First, so the Pyramid Only Sees Boxes the Camera Could See
+        mVisible.clear();
+        mHierarchy.cull(Frustum(occlusion.viewProjection() * model), mVisible);
+        std::sort(mVisible.begin(), mVisible.end());
+        stats().visible += mVisible.size();
+        stats().culled  += mBounds.size() - mVisible.size();
+        occlusion.cull(model, mBounds.data(), mVisible);
+        if (!occlusion.queries() || !mBatches.empty() || mVisible.empty()) return submit(shader, & mVisible);
+
+        // Every Proxy Goes Out Before Any Draw, so the Program Changes Twice Rather Than per Draw
+        auto & queries = occlusion.query(model, mBounds.data(), mVisible);
+        glUseProgram(shader.get());
+        for (std::size_t i = 0; i < mVisible.size(); i++)
+        {
+            if (queries[i]) glBeginConditionalRender(queries[i], GL_QUERY_NO_WAIT);
+            if (mSubMeshes.empty()) submit(shader, nullptr);
+            else mSubMeshes[mVisible[i]]->draw(shader);
+            if (queries[i]) glEndConditionalRender();
+        }
+    }
+
+    void Mesh::draw(Shader const & shader, InstanceBuffer const & instances)
+    {
+        auto count = static_cast<GLsizei>(instances.count());
+        if (count == 0) return;
+        for (auto & i : mSubMeshes) i->draw(shader, instances);
+        if (mIndexCount == 0 && mBatches.empty()) return;
+
+        // Each Sub-Mesh Binds Its Textures Once, Then Draws Every Instance
+        dequantize(shader);
+        place(shader);
+        glBindVertexArray(mVertexArray);
+        instances.attach();
+        if (mBatches.empty())
+        {
+            auto range = this->range();
+            bind(shader, mSamplers);
+            glDrawElementsInstanced(GL_TRIANGLES, range.second, mIndexType,
+                reinterpret_cast<GLvoid const *>(static_cast<std::size_t>(range.first)), count);
+            stats().draws++;
+            stats().triangles += static_cast<std::size_t>(range.second / 3) * count;
+        }
+        else
+        {
+            // baseInstance Would Offset the Instance Records Too, so Feed the Draw Index as a Constant
+            GLint unit = shader.unit(Shader::hash("materials"));
+            if (unit >= 0)
+            {
+                glActiveTexture(GL_TEXTURE0 + unit);
+                glBindTexture(GL_TEXTURE_BUFFER, mMaterialTexture);
+            }
+            glDisableVertexAttribArray(3);
+            for (auto & i : mBatches)
+            {
+                bind(shader, i.samplers);
+                for (GLsizei j = i.first; j < i.first + i.count; j++)
+                {
+                    glVertexAttribI1ui(3, mDraws.commands[j].baseInstance);
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mDraws.counts[j], mIndexType,
+                        mDraws.offsets[j], count, mDraws.baseVertices[j]);
+                    stats().draws++;
+                    stats().triangles += static_cast<std::size_t>(mDraws.counts[j] / 3) * count;
+                }
+            }
+            glEnableVertexAttribArray(3);
+        }
+        InstanceBuffer::detach();
+        glBindVertexArray(0);
+    }
+
+    void Mesh::draw(Shader const & shader, Animator const & animator)
+    {
+        // Skinned Parts Read the Animator's Stream; Rigid Parts Are Placed at Their Joint
+        GLint model   = shader.uniform(Shader::hash("model"));
+        GLint node    = shader.uniform(Shader::hash("node"));
+        GLint palette = shader.uniform(Shader::hash("palette"));
+        GLint unit    = shader.unit(Shader::hash("palettes"));
+
+        // Offsets Are Used Only When They Match the Current Mode's Layout: One per Character and
+        // Part for Streamed Vertices, One per Character for Palettes. Otherwise Parts Use Their Own Arrays
+        auto & parts = animator.mParts;
+        std::size_t characters = animator.characters().size();
+        bool streamed = animator.mode() == CpuSkinning && animator.mVertexStream
+                     && animator.mOffsets.size() == characters * parts.size();
+        bool palettes = animator.mode() == GpuSkinning && animator.mOffsets.size() == characters;
+        if (unit >= 0)
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_BUFFER, animator.mTexture);
+        }
+
+        // Arrays Without Weights Read This Constant, Which Skinning Shaders Treat as Posed Already
+        glVertexAttrib4f(10, 0.0f, 0.0f, 0.0f, 0.0f);
+        if (streamed) glBindBuffer(GL_ARRAY_BUFFER, animator.mVertexStream->buffer());
+        for (std::size_t i = 0; i < characters; i++)
+        {
+            if (model >= 0) shader.bind(model, animator.characters()[i].model);
+            if (palette >= 0 && palettes)
+                glUniform1i(palette, static_cast<GLint>(animator.mOffsets[i]));
+            for (std::size_t j = 0; j < parts.size(); j++)
+            {
+                auto & part = * parts[j];
+                if (part.mIndexCount == 0) continue;
+                bool skinned = !part.mWeights.empty();
+                bind(shader, part.mSamplers);
+                part.dequantize(shader);
+                if (node >= 0) shader.bind(node, skinned ? kIdentity : animator.joint(i, part.mJoint));
+                if (skinned && streamed)
+                {
+                    glBindVertexArray(part.mSkinnedArray);
+                    attributes(false, animator.mOffsets[i * parts.size() + j]);
+                }
+                else glBindVertexArray(part.mVertexArray);
+                auto range = part.range();
+                glDrawElements(GL_TRIANGLES, range.second, part.mIndexType,
+                    reinterpret_cast<GLvoid const *>(static_cast<std::size_t>(range.first)));
+                stats().draws++;
+                stats().triangles += range.second / 3;
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    void Mesh::enqueue(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                       float depth, unsigned int pass)
+    {
+        record(queue, shader, model, depth, pass, nullptr);
+    }
+
+    void Mesh::enqueue(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                       Frustum const & frustum, float depth, unsigned int pass)
+    {
+        // The Same Test draw(shader, frustum) Runs, so Queued Frames Do the Same Work as Direct Ones
+        mVisible.clear();
+        mHierarchy.cull(frustum, mVisible);
+        std::sort(mVisible.begin(), mVisible.end());
+        stats().visible += mVisible.size();
+        stats().culled  += mBounds.size() - mVisible.size();
+        record(queue, shader, model, depth, pass, & mVisible);
+    }
+
+    void Mesh::record(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                      float depth, unsigned int pass, std::vector<std::uint32_t> const * visible)
+    {
+        if (!mSubMeshes.empty())
+        {
+            if (visible) for (auto i : * visible) mSubMeshes[i]->record(queue, shader, model, depth, pass, nullptr);
+            else for (auto & i : mSubMeshes) i->record(queue, shader, model, depth, pass, nullptr);
+            return;
+        }
+        if ((mIndexCount == 0 && mBatches.empty()) || (visible && visible->empty())) return;
+
+        // Quantized Meshes Carry Their Dequantization Alongside the Model Matrix
+        DrawUniforms uniforms = { model, mPositionOffset, mPositionScale,
+            shader.uniform(Shader::hash("model")),
+            mQuantized ? shader.uniform(Shader::hash("positionOffset")) : -1,
+            mQuantized ? shader.uniform(Shader::hash("positionScale"))  : -1,
+            transform(), shader.uniform(Shader::hash("node")) };
+        auto range = this->range();
+        RenderCommand command = { 0, shader.get(), mVertexArray, 0, mIndexType, range.second, range.first, 0,
+                                  queue.material(nullptr, 0), 0, queue.uniforms(uniforms), -1 };
+        if (mBatches.empty())
+        {
+            std::uint32_t hash = 2166136261u;
+            for (auto & i : mSamplers)
+                Mirage::enqueue(queue, command, hash, shader.unit(i.second), GL_TEXTURE_2D, i.first);
+            command.key = RenderQueue::key(pass, command.program, hash ^ (hash >> 16), mVertexArray, depth);
+            queue.push(command);
+            stats().draws++;
+            stats().triangles += range.second / 3;
+            return;
+        }
+
+        // Merged Mode: One Command per Texture Set When Indirect Draws Exist, Otherwise One per Draw
+        DrawList const * list = & mDraws;
+        GLuint indirect = mIndirectBuffer;
+        GLintptr base = 0;
+        if (visible)
+        {
+            auto compacted = compact(* visible);
+            list     = & mCulled;
+            indirect = compacted.first;
+            base     = compacted.second;
+        }
+        std::size_t indexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        for (std::size_t i = 0; i < mBatches.size(); i++)
+        {
+            GLsizei first = visible ? mRanges[i].first  : mBatches[i].first;
+            GLsizei count = visible ? mRanges[i].second : mBatches[i].count;
+            if (count == 0) continue;
+            std::uint32_t hash = 2166136261u;
+            command.material = queue.material(nullptr, 0);
+            command.textures = 0;
+            Mirage::enqueue(queue, command, hash, shader.unit(Shader::hash("materials")),
+                            GL_TEXTURE_BUFFER, mMaterialTexture);
+            for (auto & j : mBatches[i].samplers)
+                Mirage::enqueue(queue, command, hash, shader.unit(j.second), GL_TEXTURE_2D, j.first);
+            command.key = RenderQueue::key(pass, command.program, hash ^ (hash >> 16), mVertexArray, depth);
+            if (indirect)
+            {
+                command.indirect = indirect;
+                command.count    = count;
+                command.offset   = base + static_cast<GLintptr>(first * sizeof(DrawCommand));
+                queue.push(command);
+                stats().draws++;
+            }
+            else for (GLsizei j = first; j < first + count; j++)
+            {
+                command.count      = list->counts[j];
+                command.offset     = static_cast<GLintptr>(list->commands[j].firstIndex * indexSize);
+                command.baseVertex = list->baseVertices[j];
+                command.draw       = static_cast<GLint>(list->commands[j].baseInstance);
+                queue.push(command);
+                stats().draws++;
+            }
+            for (GLsizei j = first; j < first + count; j++) stats().triangles += list->counts[j] / 3;
+        }
+    }
+
+    std::pair<GLsizei, GLsizei> Mesh::range() const
+    {
+        // Byte Offset and Index Count of the Selected Level
+        if (mChains.empty()) return std::make_pair(0, mIndexCount);
+        auto & level = mLevels[mChains.front().first + mChains.front().level];
+        std::size_t indexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        return std::make_pair(static_cast<GLsizei>(level.first * indexSize), static_cast<GLsizei>(level.count));
+    }
+
+    void Mesh::select(LodSelection const & selection)
+    {
+        // Sub-Mesh Bounds Are in Node Space; Node Scale Is Not Applied to the Error
+        for (auto & i : mSubMeshes)
+        {
+            LodSelection local = selection;
+            local.eye = glm::vec3(glm::inverse(i->transform()) * glm::vec4(selection.eye, 1.0f));
+            i->select(local);
+        }
+
+        // Keep the Current Level Inside a Band Around the Threshold, so Small Camera Moves Do Not Pop
+        bool changed = false;
+        float finer   = selection.threshold * (1.0f + selection.hysteresis);
+        float coarser = selection.threshold * (1.0f - selection.hysteresis);
+        std::size_t indexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        for (std::size_t i = 0; i < mChains.size(); i++)
+        {
+            auto & chain  = mChains[i];
+            auto & bounds = mBounds[i];
+            glm::vec3 nearest = glm::min(glm::max(selection.eye, bounds.min), bounds.max);
+            float pixels = selection.scale / std::max(glm::length(nearest - selection.eye), 1e-4f);
+            auto level = chain.level;
+            while (level > 0 && mLevels[chain.first + level].error * pixels > finer) level--;
+            while (level + 1 < chain.count && mLevels[chain.first + level + 1].error * pixels <= coarser) level++;
+            if (level == chain.level) continue;
+
+            // Merged Draws Point Their Commands at the New Range
+            chain.level = level;
+            if (mBatches.empty()) continue;
+            auto & lod = mLevels[chain.first + level];
+            mDraws.commands[i].firstIndex = lod.first;
+            mDraws.commands[i].count      = lod.count;
+            mDraws.counts[i]  = static_cast<GLsizei>(lod.count);
+            mDraws.offsets[i] = reinterpret_cast<GLvoid const *>(lod.first * indexSize);
+            changed = true;
+        }
+
+        // Orphan Rather Than Overwrite, so Last Frame's Multi-Draws Keep Reading the Old Commands
+        if (changed && mIndirectBuffer)
+        {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, mDraws.commands.size() * sizeof(DrawCommand),
+                         mDraws.commands.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+
+    void Mesh::submit(Shader const & shader, std::vector<std::uint32_t> const * visible)
+    {
+        if (!mBatches.empty()) return multiDraw(shader, visible);
+        if (!mSubMeshes.empty())
+        {
+            if (visible) for (auto i : * visible) mSubMeshes[i]->draw(shader);
+            else for (auto & i : mSubMeshes) i->draw(shader);
+            return;
+        }
+
+        if (mIndexCount == 0 || (visible && visible->empty())) return;
+        auto range = this->range();
+        bind(shader, mSamplers);
+        dequantize(shader);
+        place(shader);
+        glBindVertexArray(mVertexArray);
+        glDrawElements(GL_TRIANGLES, range.second, mIndexType,
+            reinterpret_cast<GLvoid const *>(static_cast<std::size_t>(range.first)));
+        stats().draws++;
+        stats().triangles += range.second / 3;
+    }
+
+    std::pair<GLuint, GLintptr> Mesh::compact(std::vector<std::uint32_t> const & visible)
+    {
+        // Gather Visible Draws, Recording Where Each Batch's Survivors Start
+        std::size_t indexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        std::size_t next = 0;
+        mCulled.clear();
+        mRanges.clear();
+        for (auto & i : mBatches)
+        {
+            auto first = static_cast<GLsizei>(mCulled.commands.size());
+            while (next < visible.size() && visible[next] < static_cast<std::uint32_t>(i.first + i.count))
+                mCulled.push(mDraws.commands[visible[next++]], indexSize);
+            mRanges.push_back(std::make_pair(first, static_cast<GLsizei>(mCulled.commands.size()) - first));
+        }
+
+        // The First Culled Draw of a Frame Fences the Last Region and Moves On, Growing the Ring
+        // Instead When the Last Frame Asked for More Than a Region Holds; Later Draws Sub-Allocate
+        if (!mCommands || mCulled.commands.empty()) return std::make_pair(GLuint(0), GLintptr(0));
+        if (mFrame != frames())
+        {
+            StreamBuffer::reserve(mCommands, GL_DRAW_INDIRECT_BUFFER, mCommandBytes);
+            mFrame = frames();
+            mCommandBytes = 0;
+        }
+        std::size_t bytes = mCulled.commands.size() * sizeof(DrawCommand);
+        mCommandBytes += bytes;
+        auto allocation = mCommands->write(mCulled.commands.data(), bytes, sizeof(GLuint));
+        mCommands->flush();
+        if (!allocation.data) return std::make_pair(GLuint(0), GLintptr(0));
+        return std::make_pair(mCommands->buffer(), allocation.offset);
+    }
+
+    void Mesh::multiDraw(Shader const & shader, std::vector<std::uint32_t> const * visible)
+    {
+        DrawList const * list = & mDraws;
+        GLuint indirect = mIndirectBuffer;
+        GLintptr base = 0;
+        if (visible)
+        {
+            auto compacted = compact(* visible);
+            list     = & mCulled;
+            indirect = compacted.first;
+            base     = compacted.second;
+        }
+
+        // Merged Mode: One Multi-Draw per Texture Set, or One Draw per Command Without Indirect Draws
+        GLint unit = shader.unit(Shader::hash("materials"));
+        if (unit >= 0)
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_BUFFER, mMaterialTexture);
+        }
+
+        dequantize(shader);
+        place(shader);
+        glBindVertexArray(mVertexArray);
+        if (indirect) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
+        else glDisableVertexAttribArray(3);
+        for (std::size_t i = 0; i < mBatches.size(); i++)
+        {
+            GLsizei first = visible ? mRanges[i].first  : mBatches[i].first;
+            GLsizei count = visible ? mRanges[i].second : mBatches[i].count;
+            if (count == 0) continue;
+            bind(shader, mBatches[i].samplers);
+            if (indirect)
+            {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, mIndexType,
+                    reinterpret_cast<GLvoid const *>(base + first * sizeof(DrawCommand)), count, 0);
+                stats().draws++;
+            }
+            else for (GLsizei j = first; j < first + count; j++)
+            {
+                // Without baseInstance the Array Would Read Record 0, so Feed the Draw Index as a Constant
+                glVertexAttribI1ui(3, list->commands[j].baseInstance);
+                glDrawElementsBaseVertex(GL_TRIANGLES, list->counts[j], mIndexType,
+                    list->offsets[j], list->baseVertices[j]);
+                stats().draws++;
+            }
+            for (GLsizei j = first; j < first + count; j++) stats().triangles += list->counts[j] / 3;
+        }   glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            if (!indirect) glEnableVertexAttribArray(3);
+    }
+
+    void Mesh::geometry(std::vector<Vertex> & vertices, std::vector<GLuint> & indices) const
+    {
+        auto base = static_cast<GLuint>(vertices.size());
+        vertices.insert(vertices.end(), mVertices.begin(), mVertices.end());
+        for (auto i : mIndices) indices.push_back(base + i);
+        for (auto & i : mSubMeshes) i->geometry(vertices, indices);
+    }
+
+    DrawStats & Mesh::stats()
+    {
+        static DrawStats stats;
+        return stats;
+    }
+
+    void Mesh::beginFrame()
+    {
+        frames()++;
+    }
+
+    void Mesh::finish(std::string const & filename, TextureLoader & loader)
+    {
+        loader.finish();
+        auto & report = loader.report();
+        auto & shared = TextureRegistry::global().stats();
+        fprintf(stderr, "%s: %zu textures (%zu compressed, %.1f MB), decode %.1f ms, stall %.1f ms, upload %.1f ms, mipmap %.1f ms\n",
+                filename.c_str(), report.textures, report.compressed, report.bytes / 1048576.0,
+                report.decode, report.stall, report.upload, report.mipmap);
+        if (report.unstaged > 0)
+            fprintf(stderr, "%s: %zu textures uploaded from client memory after staging failed\n",
+                    filename.c_str(), report.unstaged);
+        fprintf(stderr, "texture registry: %zu hits, %zu misses, %zu resident (%.1f MB)\n",
+                shared.hits, shared.misses, shared.textures, shared.bytes / 1048576.0);
+    }
+
+    void Mesh::optimize(std::string const & filename, Import & import)
+    {
+        // Sub-Meshes Are Independent, so Optimize Them in Parallel
+        std::vector<OptimizeReport> reports(import.entries.size());
+        ThreadPool::global().parallel(reports.size(), [&](std::size_t i) {
+            reports[i] = Mirage::optimize(import.vertices[i], import.indices[i]);
+        });
+
+        // Vertex Fetch Optimization May Shrink the Vertex Arrays; Report Each Sub-Mesh, Then the Model
+        CacheStats before = { 0.0f, 0.0f, 0 }, after = { 0.0f, 0.0f, 0 };
+        std::size_t triangles = 0;
+        for (std::size_t i = 0; i < reports.size(); i++)
+        {
+            auto & entry  = import.entries[i];
+            auto & report = reports[i];
+            fprintf(stderr, "%s[%zu]: %zu triangles, %zu -> %zu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+                    filename.c_str(), i, report.triangles, report.before.vertices, report.after.vertices, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+            entry.vertices    = import.vertices[i].data();
+            entry.vertexCount = static_cast<std::uint32_t>(import.vertices[i].size());
+            float weight = static_cast<float>(reports[i].triangles);
+            before.acmr += reports[i].before.acmr * weight; before.atvr += reports[i].before.atvr * weight;
+            after.acmr  += reports[i].after.acmr  * weight; after.atvr  += reports[i].after.atvr  * weight;
+            triangles   += reports[i].triangles;
+            before.vertices += report.before.vertices;
+            after.vertices  += report.after.vertices;
+        }
+
+        float scale = triangles > 0 ? 1.0f / triangles : 0.0f;
+        fprintf(stderr, "%s: %zu triangles, %zu -> %zu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+                filename.c_str(), triangles, before.vertices, after.vertices,
+                before.acmr * scale, after.acmr * scale, before.atvr * scale, after.atvr * scale);
+    }
+
+    void Mesh::decimate(std::string const & filename, Import & import)
+    {
+        // Levels Are Appended to Each Sub-Mesh's Own Indices, so Sub-Meshes Decimate in Parallel
+        ThreadPool::global().parallel(import.entries.size(), [&](std::size_t i) {
+            import.entries[i].levels = simplify(import.vertices[i], import.indices[i], import.options.lods);
+        });
+
+        std::vector<std::size_t> triangles;
+        for (std::size_t i = 0; i < import.entries.size(); i++)
+        {
+            auto & entry = import.entries[i];
+            entry.indices    = import.indices[i].data();
+            entry.indexCount = static_cast<std::uint32_t>(import.indices[i].size());
+            for (std::size_t j = 0; j < entry.levels.size(); j++)
+            {
+                if (triangles.size() <= j) triangles.push_back(0);
+                triangles[j] += entry.levels[j].count / 3;
+            }
+        }
+
+        std::string summary;
+        for (auto i : triangles) summary += (summary.empty() ? "" : " -> ") + std::to_string(i);
+        fprintf(stderr, "%s: levels of detail %s triangles\n", filename.c_str(), summary.c_str());
+    }
+
+    void Mesh::parse(aiNode const * node, aiScene const * scene, Import & import, std::uint32_t parent)
+    {
+        // Record the Node Before Its Children, so Parents Always Precede Them
+        MeshCache::Node record = { parent, convert(node->mTransformation) };
+        auto id = static_cast<std::uint32_t>(import.nodes.size());
+        import.nodes.push_back(record);
         for (unsigned int i = 0; i < node->mNumMeshes; i++)
-            parse(path, scene->mMeshes[node->mMeshes[i]], scene);
+        {
+            auto mesh = scene->mMeshes[node->mMeshes[i]];
+            parse(mesh, scene, import);
+            import.entries.back().node = id;
+            if (mesh->HasBones() && mSkeleton) weigh(mesh, import, id);
+        }
         for (unsigned int i = 0; i < node->mNumChildren; i++)
-            parse(path, node->mChildren[i], scene);
+            parse(node->mChildren[i], scene, import, id);
     }
 
-    void Mesh::parse(std::string const & path, aiMesh const * mesh, aiScene const * scene)
+    void Mesh::parse(aiMesh const * mesh, aiScene const * scene, Import & import)
     {
-        // Create Vertex Data from Mesh Node
-        std::vector<Vertex> vertices; Vertex vertex;
+        // Create Vertex Data from Mesh Node, Sized Exactly Up Front
+        std::vector<Vertex> vertices(mesh->mNumVertices);
         for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {   if (mesh->mTextureCoords[0])
-            vertex.uv       = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+        {   auto & vertex = vertices[i];
+            vertex.uv       = mesh->mTextureCoords[0] ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y)
+                                                      : glm::vec2(0.0f);
             vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
             vertex.normal   = glm::vec3(mesh->mNormals[i].x,  mesh->mNormals[i].y,  mesh->mNormals[i].z);
-            vertices.push_back(vertex);
         }
 
-        // Create Mesh Indices for Indexed Drawing
-        std::vector<GLuint> indices;
+        // Create Mesh Indices for Indexed Drawing; Count Them First so They Fill One Allocation
+        std::size_t count = 0;
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++) count += mesh->mFaces[i].mNumIndices;
+        std::vector<GLuint> indices(count);
+        auto index = indices.begin();
         for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-        for (unsigned int j = 0; j < mesh->mFaces[i].mNumIndices; j++)
-            indices.push_back(mesh->mFaces[i].mIndices[j]);
+            index = std::copy(mesh->mFaces[i].mIndices, mesh->mFaces[i].mIndices + mesh->mFaces[i].mNumIndices, index);
 
         // Load Mesh Textures into VRAM
-        std::map<GLuint, std::string> textures;
-        auto diffuse  = process(path, scene->mMaterials[mesh->mMaterialIndex], aiTextureType_DIFFUSE);
-        auto specular = process(path, scene->mMaterials[mesh->mMaterialIndex], aiTextureType_SPECULAR);
-        textures.insert(diffuse.begin(), diffuse.end());
-        textures.insert(specular.begin(), specular.end());
+        auto sources  = gather(scene->mMaterials[mesh->mMaterialIndex], aiTextureType_DIFFUSE);
+        auto specular = gather(scene->mMaterials[mesh->mMaterialIndex], aiTextureType_SPECULAR);
+        sources.insert(sources.end(), specular.begin(), specular.end());
 
-        // Create New Mesh Node
-        mSubMeshes.push_back(std::unique_ptr<Mesh>(new Mesh(vertices, indices, textures)));
+        // Stage the Sub-Mesh for Upload and Caching
+        MeshCache::Entry entry;
+        entry.vertices    = vertices.data();
+        entry.indices     = indices.data();
+        entry.vertexCount = static_cast<std::uint32_t>(vertices.size());
+        entry.indexCount  = static_cast<std::uint32_t>(indices.size());
+        entry.textures    = sources;
+        import.entries.push_back(entry);
+        import.textures.push_back(process(import.path, sources, import.loader));
+        import.vertices.push_back(std::move(vertices));
+        import.indices.push_back(std::move(indices));
+        import.weights.push_back(std::vector<VertexWeights>());
     }
 
-    std::map<GLuint, std::string> Mesh::process(std::string const & path,
-                                                aiMaterial * material,
-                                                aiTextureType type)
+    void Mesh::weigh(aiMesh const * mesh, Import & import, std::uint32_t joint)
     {
-        std::map<GLuint, std::string> textures;
-        for(unsigned int i = 0; i < material->GetTextureCount(type); i++)
+        // Keep the Four Strongest Influences on Each Vertex
+        VertexWeights none = { { 0, 0, 0, 0 }, { 0.0f, 0.0f, 0.0f, 0.0f } };
+        auto & weights = import.weights.back();
+        weights.assign(mesh->mNumVertices, none);
+        for (unsigned int i = 0; i < mesh->mNumBones; i++)
         {
-            // Define Some Local Variables
-            GLenum format;
-            GLuint texture;
-            std::string mode;
-
-            // Load the Texture Image from File
-            aiString str; material->GetTexture(type, i, & str);
-            std::string filename = str.C_Str(); int width, height, channels;
-            filename = PROJECT_SOURCE_DIR "/Mirage/Models/" + path + "/" + filename;
-            unsigned char * image = stbi_load(filename.c_str(), & width, & height, & channels, 0);
-            if (!image) fprintf(stderr, "%s %s\n", "Failed to Load Texture", filename.c_str());
-
-            // Set the Correct Channel Format
-            switch (channels)
+            auto bone = mSkeleton->bone(mesh->mBones[i]);
+            if (bone == Skeleton::none) continue;
+            for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++)
             {
-                case 1 : format = GL_ALPHA;     break;
-                case 2 : format = GL_LUMINANCE; break;
-                case 3 : format = GL_RGB;       break;
-                case 4 : format = GL_RGBA;      break;
+                auto & influence = mesh->mBones[i]->mWeights[j];
+                auto & vertex = weights[influence.mVertexId];
+                int weakest = 0;
+                for (int k = 1; k < 4; k++) if (vertex.weights[k] < vertex.weights[weakest]) weakest = k;
+                if (influence.mWeight <= vertex.weights[weakest]) continue;
+                vertex.bones[weakest]   = static_cast<GLushort>(bone);
+                vertex.weights[weakest] = influence.mWeight;
             }
+        }
+
+        // Renormalize What Was Kept; Vertices No Bone Reaches Follow the Mesh's Own Node
+        std::uint32_t rigid = Skeleton::none;
+        for (auto & i : weights)
+        {
+            float total = i.weights[0] + i.weights[1] + i.weights[2] + i.weights[3];
+            if (total > 0.0f) { for (auto & j : i.weights) j /= total; continue; }
+            if (rigid == Skeleton::none) rigid = mSkeleton->bone(joint, kIdentity);
+            i.bones[0]   = static_cast<GLushort>(rigid);
+            i.weights[0] = 1.0f;
+        }
+    }
 
-            // Bind Texture and Set Filtering Levels
-            glGenTextures(1, & texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, format,
-                         width, height, 0, format, GL_UNSIGNED_BYTE, image);
-            glGenerateMipmap(GL_TEXTURE_2D);
-
-            // Release Image Pointer and Store the Texture
-            stbi_image_free(image);
-                 if (type == aiTextureType_DIFFUSE)  mode = "diffuse";
-            else if (type == aiTextureType_SPECULAR) mode = "specular";
-            textures.insert(std::make_pair(texture, mode));
+    std::vector<TextureSource> Mesh::gather(aiMaterial * material, aiTextureType type)
+    {
+        std::vector<TextureSource> sources;
+        for (unsigned int i = 0; i < material->GetTextureCount(type); i++)
+        {
+            aiString str; material->GetTexture(type, i, & str);
+            TextureSource source;
+            source.filename = str.C_Str();
+                 if (type == aiTextureType_DIFFUSE)  source.mode = "diffuse";
+            else if (type == aiTextureType_SPECULAR) source.mode = "specular";
+            sources.push_back(source);
+        }   return sources;
+    }
+
+    std::multimap<GLuint, std::string> Mesh::process(std::string const & path,
+                                                std::vector<TextureSource> const & sources,
+                                                TextureLoader & loader)
+    {
+        std::multimap<GLuint, std::string> textures;
+        for (auto & source : sources)
+        {   // Share Already Loaded Images, Otherwise Queue the Decode; an Image Used in Several
+            // Modes Keeps One Entry, and One Reference, per Mode
+            auto filename = PROJECT_SOURCE_DIR "/Mirage/Models/" + path + "/" + source.filename;
+            auto texture  = TextureRegistry::global().acquire(filename, loader);
+            auto uses     = textures.equal_range(texture);
+            if (std::find_if(uses.first, uses.second, [&](std::pair<GLuint const, std::string> const & i) {
+                    return i.second == source.mode; }) != uses.second)
+                TextureRegistry::global().release(texture);
+            else textures.insert(std::make_pair(texture, source.mode));
         }   return textures;
     }
 };
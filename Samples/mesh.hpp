@@ -1,20 +1,37 @@
 #pragma once
 
+// Local Headers
+#include "culling.hpp"
+#include "instances.hpp"
+#include "queue.hpp"
+#include "scene.hpp"
+#include "shader.hpp"
+#include "skeleton.hpp"
+#include "stream.hpp"
+
 // System Headers
-#include <assimp/importer.hpp>
+#include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 // Standard Headers
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Define Namespace
 namespace Mirage
 {
+    // Forward Declarations
+    class Animator;
+    class OcclusionCuller;
+    class TextureLoader;
+
     // Vertex Format
     struct Vertex {
         glm::vec3 position;
@@ -22,22 +39,132 @@ namespace Mirage
         glm::vec2 uv;
     };
 
+    // Material Texture Reference, Relative to the Model Directory
+    struct TextureSource {
+        std::string filename;
+        std::string mode;
+    };
+
+    // Layout of One glMultiDrawElementsIndirect Record
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint  baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Index Range of One Level of Detail and Its RMS Quadric Error Against the Full Mesh
+    struct LevelOfDetail {
+        std::uint32_t first;
+        std::uint32_t count;
+        float error;
+    };
+
+    // Options Controlling How a Model File Is Imported
+    struct ImportOptions {
+        bool merge    = false; // Pack Sub-Meshes into Shared Buffers and Multi-Draw Them
+        bool quantize = false; // Store 16-Byte PackedVertex Instead of 32-Byte Vertex
+        bool optimize = false; // Reorder for Vertex Cache, Overdraw and Fetch Before Caching
+        bool keep     = false; // Keep CPU Copies of Geometry for Physics and Tools
+        unsigned int lods = 0; // Coarser Levels to Generate per Sub-Mesh, Each Half the Last
+    };
+
+    // CPU Memory Held by One Model Import, in Bytes; Cached Geometry Is Mapped, Not Counted
+    struct ImportReport {
+        std::size_t geometry = 0; // Vertices and Indices Imported, Before Any Packing
+        std::size_t peak     = 0; // Most Held at Once, Including Assimp's Scene
+        std::size_t kept     = 0; // Still Held Once Loaded
+    };
+
+    // Draw Calls and Triangles Submitted, and Frustum Test Outcomes, Since the Last Reset
+    struct DrawStats {
+        std::size_t draws     = 0;
+        std::size_t triangles = 0;
+        std::size_t visible   = 0;
+        std::size_t culled    = 0;
+    };
+
+    // Screen-Space Error Budget for Picking Levels of Detail
+    struct LodSelection {
+        glm::vec3 eye;             // Camera Position in the Mesh's Model Space
+        float scale;               // Viewport Height / (2 tan(fov / 2)), in Pixels
+        float threshold  = 1.0f;   // Largest Tolerated RMS Quadric Error in Pixels
+        float hysteresis = 0.25f;  // Fraction of the Threshold a Level Must Clear Before Switching
+    };
+
     class Mesh
     {
     public:
 
         // Implement Default Constructor and Destructor
          Mesh() { glGenVertexArrays(1, & mVertexArray); }
-        ~Mesh() { glDeleteVertexArrays(1, & mVertexArray); }
+        ~Mesh();
+
+        // Implement Custom Constructors; Geometry Passed by Vector Is Moved In When the Caller
+        // Allows It, and Freed After Upload Unless Kept for geometry()
+        Mesh(std::string const & filename, ImportOptions const & options = ImportOptions());
+        Mesh(std::vector<Vertex> vertices,
+             std::vector<GLuint> indices,
+             std::multimap<GLuint, std::string> const & textures,
+             bool keep = false);
+        Mesh(Vertex const * vertices, std::size_t vertexCount,
+             GLuint const * indices,  std::size_t indexCount,
+             std::multimap<GLuint, std::string> const & textures,
+             bool quantize = false);
 
-        // Implement Custom Constructors
-        Mesh(std::string const & filename);
-        Mesh(std::vector<Vertex> const & vertices,
-             std::vector<GLuint> const & indices,
-             std::map<GLuint, std::string> const & textures);
+        // Skinned by Up to Four Bones of a Skeleton per Vertex
+        Mesh(Vertex const * vertices, std::size_t vertexCount,
+             GLuint const * indices,  std::size_t indexCount,
+             VertexWeights const * weights, std::shared_ptr<Skeleton> const & skeleton,
+             std::multimap<GLuint, std::string> const & textures);
 
         // Public Member Functions
-        void draw(GLuint shader);
+        void draw(Shader const & shader);
+        void draw(Shader const & shader, Frustum const & frustum);
+        void draw(Shader const & shader, InstanceBuffer const & instances);
+
+        // Cull Against the Culler's Camera and Then Its Depth Pyramid, and Draw Survivors Under
+        // Its Occlusion Queries When Enabled; Merged Models Skip the Queries
+        void draw(Shader const & shader, OcclusionCuller & occlusion, glm::mat4 const & model);
+
+        // Draw Every Character in Its Pose; Skinned Parts Use the Animator's Current Back End
+        void draw(Shader const & shader, Animator const & animator);
+
+        // Queue This Mesh's Draws for Sorting Instead of Issuing Them; Depth Is in [0, 1]. With a
+        // Frustum in Model Space, Only the Draws draw(shader, frustum) Would Issue Are Queued.
+        void enqueue(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                     float depth = 0.0f, unsigned int pass = 0);
+        void enqueue(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                     Frustum const & frustum, float depth = 0.0f, unsigned int pass = 0);
+
+        // Pick Each Sub-Mesh's Coarsest Level Whose Projected Error Fits the Budget
+        void select(LodSelection const & selection);
+
+        // Append CPU Geometry of This Mesh and Its Sub-Meshes; Empty Unless Kept
+        void geometry(std::vector<Vertex> & vertices, std::vector<GLuint> & indices) const;
+
+        // Imported Node Hierarchy; After Moving Nodes, update() Propagates Them to Sub-Meshes
+        // and Their Bounds. Merged Models Bake Node Transforms at Import and Ignore Later Changes.
+        SceneGraph & scene() { return mScene; }
+        void update();
+
+        // Joints, Bones and Clips of an Animated Model; Null for Static Ones
+        std::shared_ptr<Skeleton> const & skeleton() const { return mSkeleton; }
+
+        // Whether Sub-Meshes Were Packed into Shared Buffers; Their Draws Feed Attribute 3 and
+        // the materials Buffer Texture, Which merged.vert Reads
+        bool merged() const { return !mBatches.empty(); }
+
+        // Memory the Import from File Used; Empty for Meshes Built from Memory
+        ImportReport const & imported() const { return mImported; }
+
+        // Process-Wide Submission Counters; Callers Reset Them per Frame
+        static DrawStats & stats();
+
+        // Call Once per Frame. Culled Merged Draws Share One Region of Each Mesh's Command Ring
+        // Until the Next Frame Begins, so Drawing a Mesh Many Times Never Waits on Its Own Fences
+        static void beginFrame();
 
     private:
 
@@ -45,23 +172,117 @@ namespace Mirage
         Mesh(Mesh const &) = delete;
         Mesh & operator=(Mesh const &) = delete;
 
+        // Animators Skin Straight from the Bind Pose of Each Part
+        friend class Animator;
+
+        // Staging Shared by the Assimp and Cache Import Paths
+        struct Import;
+
+        // Draws Sharing One Set of Textures in Merged Mode
+        struct Batch {
+            std::multimap<GLuint, std::string> textures;
+            std::vector<std::pair<GLuint, std::uint32_t>> samplers;
+            GLsizei first;
+            GLsizei count;
+        };
+
+        // Merged Mode Draws in the Layouts Both Multi-Draw Paths Expect
+        struct DrawList {
+            std::vector<DrawCommand> commands;
+            std::vector<GLsizei> counts;
+            std::vector<GLvoid const *> offsets;
+            std::vector<GLint> baseVertices;
+            void push(DrawCommand const & command, std::size_t indexSize);
+            void clear();
+        };
+
+        // Levels of Detail of One Draw: a Range of mLevels and the Selected Level
+        struct Chain {
+            std::uint32_t first;
+            std::uint32_t count;
+            std::uint32_t level;
+        };
+
         // Private Member Functions
-        void parse(std::string const & path, aiNode const * node, aiScene const * scene);
-        void parse(std::string const & path, aiMesh const * mesh, aiScene const * scene);
-        std::map<GLuint, std::string> process(std::string const & path,
-                                              aiMaterial * material,
-                                              aiTextureType type);
+        std::pair<GLsizei, GLsizei> range() const;
+        void submit(Shader const & shader, std::vector<std::uint32_t> const * visible);
+        void multiDraw(Shader const & shader, std::vector<std::uint32_t> const * visible);
+        void record(RenderQueue & queue, Shader const & shader, glm::mat4 const & model,
+                    float depth, unsigned int pass, std::vector<std::uint32_t> const * visible);
+        std::pair<GLuint, GLintptr> compact(std::vector<std::uint32_t> const & visible);
+        void parse(aiNode const * node, aiScene const * scene, Import & import, std::uint32_t parent);
+        void parse(aiMesh const * mesh, aiScene const * scene, Import & import);
+        void weigh(aiMesh const * mesh, Import & import, std::uint32_t joint);
+        void finish(std::string const & filename, TextureLoader & loader);
+        void merge(Import & import);
+        void flatten(Import & import);
+        void optimize(std::string const & filename, Import & import);
+        void decimate(std::string const & filename, Import & import);
+        void upload(Vertex const * vertices, std::size_t vertexCount,
+                    GLuint const * indices,  std::size_t indexCount, bool quantize);
+        void skin();
+        void dequantize(Shader const & shader) const;
+        void place(Shader const & shader) const;
+        glm::mat4 const & transform() const;
+        static void attributes(bool quantized, GLintptr offset = 0);
+        static void bind(Shader const & shader, std::vector<std::pair<GLuint, std::uint32_t>> const & samplers);
+        static std::vector<std::pair<GLuint, std::uint32_t>> samplers(std::multimap<GLuint, std::string> const & textures);
+        std::vector<TextureSource> gather(aiMaterial * material, aiTextureType type);
+        std::multimap<GLuint, std::string> process(std::string const & path,
+                                              std::vector<TextureSource> const & sources,
+                                              TextureLoader & loader);
 
         // Private Member Containers
         std::vector<std::unique_ptr<Mesh>> mSubMeshes;
         std::vector<GLuint> mIndices;
         std::vector<Vertex> mVertices;
-        std::map<GLuint, std::string> mTextures;
+        std::multimap<GLuint, std::string> mTextures;
+        std::vector<std::pair<GLuint, std::uint32_t>> mSamplers;
+
+        // Merged Mode Draw Lists; the Culled List Is Rebuilt Each Frame and, With Indirect
+        // Draws, Streamed Through a Ring so Earlier Frames Keep Reading Their Own Commands
+        std::vector<Batch> mBatches;
+        DrawList mDraws;
+        DrawList mCulled;
+        std::vector<std::pair<GLsizei, GLsizei>> mRanges;
+        std::unique_ptr<StreamBuffer> mCommands;
+        std::uint64_t mFrame = ~std::uint64_t(0); // Frame the Ring's Current Region Belongs To
+        std::size_t mCommandBytes = 0;            // Command Bytes That Frame Asked For
+
+        // Bounds per Sub-Mesh, or per Draw in Merged Mode, and the Hierarchy over Them
+        std::vector<Bounds> mBounds;
+        BoundingVolumeHierarchy mHierarchy;
+        std::vector<std::uint32_t> mVisible;
+
+        // Levels of Detail, One Chain per Draw; Empty Without Levels
+        std::vector<LevelOfDetail> mLevels;
+        std::vector<Chain> mChains;
+
+        // Node Hierarchy of an Imported Model; Sub-Meshes Point Back at Their Node
+        SceneGraph mScene;
+        SceneGraph const * mGraph = nullptr;
+        std::uint32_t mNode = 0;
+
+        // Bind Pose and Bone Influences of Skinned Parts; Rigid Parts Follow Their Joint
+        std::vector<Vertex> mBindPose;
+        std::vector<VertexWeights> mWeights;
+        std::shared_ptr<Skeleton> mSkeleton;
+        std::uint32_t mJoint = 0;
 
         // Private Member Variables
+        ImportReport mImported;
+        GLsizei mIndexCount = 0;
+        GLenum  mIndexType  = GL_UNSIGNED_INT;
+        bool    mQuantized  = false;
+        glm::vec3 mPositionOffset;
+        glm::vec3 mPositionScale;
         GLuint mVertexArray;
+        GLuint mSkinnedArray = 0; // Indices Only; Vertices Come from an Animator's Stream
         GLuint mVertexBuffer;
         GLuint mElementBuffer;
+        GLuint mIndirectBuffer  = 0;
+        GLuint mMaterialBuffer  = 0;
+        GLuint mMaterialTexture = 0;
 
     };
 };
@@ -0,0 +1,387 @@
+// Local Headers
+#include "occlusion.hpp"
+#include "platform.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Frames of Depth in Flight Before capture() Overwrites One Not Yet Read
+        const std::size_t kReadbacks = 3;
+        const GLuint64 kTimeout = 1000000; // Nanoseconds per Blocking Wait
+
+        // Size of a Pyramid Level, Each Half the Last, Rounded Up
+        GLsizei extent(GLsizei size, std::size_t level) { return ((size - 1) >> level) + 1; }
+
+        // Project Four Boxes at Once; Lane i of rect Gets Box i's Normalized Device Rectangle
+        // (minX, minY, maxX, maxY) and Nearest Depth, and Bit i of Clipped Is Set When Box i Reaches
+        // Past the Near Plane, Where Its Rectangle Means Nothing
+        void project(float const (&box)[6][4], glm::mat4 const & m, float (&rect)[5][4], int & clipped)
+        {
+        #ifdef MIRAGE_SSE
+            // Each Clip Coordinate Is a Sum of One Term per Axis; Both Choices of Each Are Made Once
+            __m128 lo[3] = { _mm_loadu_ps(box[0]), _mm_loadu_ps(box[1]), _mm_loadu_ps(box[2]) };
+            __m128 hi[3] = { _mm_loadu_ps(box[3]), _mm_loadu_ps(box[4]), _mm_loadu_ps(box[5]) };
+            __m128 terms[4][3][2];
+            for (int r = 0; r < 4; r++)
+            for (int a = 0; a < 3; a++)
+            {
+                __m128 scale = _mm_set1_ps(m[a][r]);
+                __m128 shift = _mm_set1_ps(a == 2 ? m[3][r] : 0.0f);
+                terms[r][a][0] = _mm_add_ps(_mm_mul_ps(scale, lo[a]), shift);
+                terms[r][a][1] = _mm_add_ps(_mm_mul_ps(scale, hi[a]), shift);
+            }
+
+            __m128 minX = _mm_set1_ps( std::numeric_limits<float>::max()), minY = minX, minZ = minX;
+            __m128 maxX = _mm_set1_ps(-std::numeric_limits<float>::max()), maxY = maxX;
+            __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), behind = zero;
+            for (int c = 0; c < 8; c++)
+            {
+                int x = c & 1, y = (c >> 1) & 1, z = (c >> 2) & 1;
+                __m128 clip[4];
+                for (int r = 0; r < 4; r++)
+                    clip[r] = _mm_add_ps(_mm_add_ps(terms[r][0][x], terms[r][1][y]), terms[r][2][z]);
+                behind = _mm_or_ps(behind, _mm_cmple_ps(clip[3], zero));
+                behind = _mm_or_ps(behind, _mm_cmplt_ps(_mm_add_ps(clip[2], clip[3]), zero));
+                __m128 inverse = _mm_div_ps(one, clip[3]);
+                __m128 nx = _mm_mul_ps(clip[0], inverse), ny = _mm_mul_ps(clip[1], inverse);
+                minX = _mm_min_ps(minX, nx); maxX = _mm_max_ps(maxX, nx);
+                minY = _mm_min_ps(minY, ny); maxY = _mm_max_ps(maxY, ny);
+                minZ = _mm_min_ps(minZ, _mm_mul_ps(clip[2], inverse));
+            }
+            _mm_storeu_ps(rect[0], minX); _mm_storeu_ps(rect[1], minY);
+            _mm_storeu_ps(rect[2], maxX); _mm_storeu_ps(rect[3], maxY);
+            _mm_storeu_ps(rect[4], minZ);
+            clipped = _mm_movemask_ps(behind);
+        #else
+            clipped = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                rect[0][i] = rect[1][i] = rect[4][i] =  std::numeric_limits<float>::max();
+                rect[2][i] = rect[3][i] = -std::numeric_limits<float>::max();
+                for (int c = 0; c < 8; c++)
+                {
+                    glm::vec4 clip = m * glm::vec4(box[(c & 1) ? 3 : 0][i], box[(c & 2) ? 4 : 1][i],
+                                                   box[(c & 4) ? 5 : 2][i], 1.0f);
+                    if (clip.w <= 0.0f || clip.z + clip.w < 0.0f) { clipped |= 1 << i; break; }
+                    rect[0][i] = std::min(rect[0][i], clip.x / clip.w);
+                    rect[1][i] = std::min(rect[1][i], clip.y / clip.w);
+                    rect[2][i] = std::max(rect[2][i], clip.x / clip.w);
+                    rect[3][i] = std::max(rect[3][i], clip.y / clip.w);
+                    rect[4][i] = std::min(rect[4][i], clip.z / clip.w);
+                }
+            }
+        #endif
+        }
+
+        // Whether the Near Plane Cuts a Box, so Its Proxy Could Be Clipped Away While It Shows
+        bool reaches(glm::mat4 const & matrix, Bounds const & box)
+        {
+            for (int c = 0; c < 8; c++)
+            {
+                glm::vec4 clip = matrix * glm::vec4((c & 1) ? box.max.x : box.min.x, (c & 2) ? box.max.y : box.min.y,
+                                                    (c & 4) ? box.max.z : box.min.z, 1.0f);
+                if (clip.w <= 0.0f || clip.z + clip.w < 0.0f) return true;
+            }   return false;
+        }
+    }
+
+    OcclusionCuller::OcclusionCuller(GLsizei width, GLsizei height)
+        : mReadbacks(kReadbacks)
+        , mWidth(std::max<GLsizei>(width, 1))
+        , mHeight(std::max<GLsizei>(height, 1))
+        , mCurrent(1.0f)
+        , mMatrix(1.0f)
+    {
+        // Levels Halve Until One Texel Covers the Screen
+        std::size_t offset = 0;
+        for (std::size_t level = 0; ; level++)
+        {
+            mLevels.push_back(offset);
+            offset += static_cast<std::size_t>(extent(mWidth, level)) * extent(mHeight, level);
+            if (extent(mWidth, level) == 1 && extent(mHeight, level) == 1) break;
+        }
+        mPyramid.resize(offset);
+        mProxy.attach("occlusion.vert").attach("occlusion.frag").compile();
+    }
+
+    OcclusionCuller::~OcclusionCuller()
+    {
+        for (auto & i : mReadbacks)
+        {
+            if (i.fence) glDeleteSync(i.fence);
+            glDeleteBuffers(1, & i.buffer);
+        }
+        if (!mPool.empty()) glDeleteQueries(static_cast<GLsizei>(mPool.size()), mPool.data());
+        glDeleteFramebuffers(1, & mFramebuffer);
+        glDeleteRenderbuffers(1, & mRenderbuffer);
+        glDeleteVertexArrays(1, & mVertexArray);
+        glDeleteBuffers(1, & mVertexBuffer);
+        glDeleteBuffers(1, & mElementBuffer);
+    }
+
+    void OcclusionCuller::begin()
+    {
+        // Depth-Only Target at the Pyramid's Resolution, Made on First Use
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, & mBound);
+        glGetIntegerv(GL_VIEWPORT, mViewport);
+        if (mFramebuffer == 0)
+        {
+            glGenRenderbuffers(1, & mRenderbuffer);
+            glBindRenderbuffer(GL_RENDERBUFFER, mRenderbuffer);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, mWidth, mHeight);
+            glGenFramebuffers(1, & mFramebuffer);
+            glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRenderbuffer);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glViewport(0, 0, mWidth, mHeight);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    void OcclusionCuller::end(glm::mat4 const & viewProjection)
+    {
+        capture(mWidth, mHeight, viewProjection);
+        glBindFramebuffer(GL_FRAMEBUFFER, mBound);
+        glViewport(mViewport[0], mViewport[1], mViewport[2], mViewport[3]);
+    }
+
+    void OcclusionCuller::capture(GLsizei width, GLsizei height, glm::mat4 const & viewProjection)
+    {
+        // The Copy Lands in a Pack Buffer on the GPU's Time; update() Maps It Once Fenced
+        auto start = Clock::now();
+        auto & readback = mReadbacks[mNext];
+        mNext = (mNext + 1) % mReadbacks.size();
+        std::size_t bytes = static_cast<std::size_t>(width) * height * sizeof(float);
+        if (readback.buffer == 0) glGenBuffers(1, & readback.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        if (readback.capacity < bytes)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            readback.capacity = bytes;
+        }
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (readback.fence) glDeleteSync(readback.fence);
+        readback.fence  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.width  = width;
+        readback.height = height;
+        readback.matrix = viewProjection;
+        mStats.build += milliseconds(start);
+    }
+
+    bool OcclusionCuller::update(glm::mat4 const & viewProjection, bool wait)
+    {
+        auto start = Clock::now();
+        mCurrent = viewProjection;
+
+        // Proxies That Passed No Samples Had Their Draws Skipped; Pending Results Are Not Counted
+        for (std::size_t i = 0; i < mUsed; i++)
+        {
+            GLuint available = 0, passed = 1;
+            glGetQueryObjectuiv(mPool[i], GL_QUERY_RESULT_AVAILABLE, & available);
+            if (available) glGetQueryObjectuiv(mPool[i], GL_QUERY_RESULT, & passed);
+            if (passed == 0) mStats.discarded++;
+        }   mUsed = 0;
+
+        // Newest Readback Whose Fence Has Signalled; Only the Newest Is Ever Waited On
+        std::size_t count = mReadbacks.size(), found = 0;
+        for (std::size_t i = 1; i <= count && found == 0; i++)
+        {
+            auto & readback = mReadbacks[(mNext + count - i) % count];
+            if (readback.fence == nullptr) continue;
+            GLenum status = glClientWaitSync(readback.fence, 0, 0);
+            while (status == GL_TIMEOUT_EXPIRED && wait && i == 1)
+                status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) found = i;
+        }
+        if (found == 0) { mStats.build += milliseconds(start); return mBuilt; }
+
+        // Older Readbacks Are Superseded, so Drop Their Fences Too
+        auto & newest = mReadbacks[(mNext + count - found) % count];
+        for (std::size_t i = found; i <= count; i++)
+        {
+            auto & readback = mReadbacks[(mNext + count - i) % count];
+            if (readback.fence) glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, newest.buffer);
+        std::size_t bytes = static_cast<std::size_t>(newest.width) * newest.height * sizeof(float);
+        auto depth = static_cast<float const *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+        if (depth)
+        {
+            build(newest, depth);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        mStats.build += milliseconds(start);
+        return mBuilt;
+    }
+
+    void OcclusionCuller::build(Readback const & readback, float const * depth)
+    {
+        // Finest Level Keeps the Farthest Depth Under Each Texel, so No Texel Hides More Than It Should
+        std::size_t sw = readback.width, sh = readback.height;
+        std::size_t bw = mWidth, bh = mHeight;
+        float * base = mPyramid.data();
+        ThreadPool::global().parallel(bh, [&](std::size_t y) {
+            std::size_t y0 = y * sh / bh, y1 = std::min(sh, std::max(y0 + 1, ((y + 1) * sh + bh - 1) / bh));
+            for (std::size_t x = 0; x < bw; x++)
+            {
+                std::size_t x0 = x * sw / bw, x1 = std::min(sw, std::max(x0 + 1, ((x + 1) * sw + bw - 1) / bw));
+                float farthest = 0.0f;
+                for (std::size_t i = y0; i < y1; i++)
+                for (std::size_t j = x0; j < x1; j++)
+                    farthest = std::max(farthest, depth[i * sw + j]);
+                base[y * bw + x] = farthest;
+            }
+        });
+
+        // Each Coarser Texel Keeps the Farthest of the Up to Four Beneath It
+        for (std::size_t level = 1; level < mLevels.size(); level++)
+        {
+            GLsizei fw = extent(mWidth, level - 1), fh = extent(mHeight, level - 1);
+            GLsizei w  = extent(mWidth, level),     h  = extent(mHeight, level);
+            float const * finer = & mPyramid[mLevels[level - 1]];
+            float * coarser = & mPyramid[mLevels[level]];
+            for (GLsizei y = 0; y < h; y++)
+            for (GLsizei x = 0; x < w; x++)
+            {
+                GLsizei x0 = 2 * x, x1 = std::min(2 * x + 1, fw - 1);
+                GLsizei y0 = 2 * y, y1 = std::min(2 * y + 1, fh - 1);
+                coarser[y * w + x] = std::max(std::max(finer[y0 * fw + x0], finer[y0 * fw + x1]),
+                                              std::max(finer[y1 * fw + x0], finer[y1 * fw + x1]));
+            }
+        }
+        mMatrix = readback.matrix;
+        mBuilt  = true;
+    }
+
+    bool OcclusionCuller::occluded(float minX, float minY, float maxX, float maxY, float depth) const
+    {
+        // Boxes Off This Pyramid's Screen Were Framed by Another Camera, So Nothing Is Known
+        float u0 = (minX * 0.5f + 0.5f) * mWidth,  u1 = (maxX * 0.5f + 0.5f) * mWidth;
+        float v0 = (minY * 0.5f + 0.5f) * mHeight, v1 = (maxY * 0.5f + 0.5f) * mHeight;
+        if (u1 < 0.0f || v1 < 0.0f || u0 >= mWidth || v0 >= mHeight) return false;
+        GLsizei x0 = static_cast<GLsizei>(std::max(u0, 0.0f)), x1 = std::min(static_cast<GLsizei>(u1), mWidth - 1);
+        GLsizei y0 = static_cast<GLsizei>(std::max(v0, 0.0f)), y1 = std::min(static_cast<GLsizei>(v1), mHeight - 1);
+
+        // Coarsest Level Where the Rectangle Still Spans at Most Two Texels Each Way
+        std::size_t level = 0;
+        while (level + 1 < mLevels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+            level++;
+        GLsizei w = extent(mWidth, level);
+        float const * texels = & mPyramid[mLevels[level]];
+        float farthest = 0.0f;
+        for (GLsizei y = y0 >> level; y <= (y1 >> level); y++)
+        for (GLsizei x = x0 >> level; x <= (x1 >> level); x++)
+            farthest = std::max(farthest, texels[y * w + x]);
+        return depth > farthest;
+    }
+
+    void OcclusionCuller::cull(glm::mat4 const & model, Bounds const * bounds, std::vector<std::uint32_t> & visible)
+    {
+        if (!mBuilt || visible.empty()) return;
+        auto start = Clock::now();
+        glm::mat4 matrix = mMatrix * model;
+
+        // Gather Four Boxes into Lanes, Padding with the Last, and Compact Survivors in Place
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < visible.size(); i += 4)
+        {
+            std::size_t lanes = std::min<std::size_t>(4, visible.size() - i);
+            std::uint32_t items[4];
+            float box[6][4], rect[5][4];
+            for (std::size_t j = 0; j < 4; j++)
+            {
+                items[j] = visible[i + std::min(j, lanes - 1)];
+                auto & b = bounds[items[j]];
+                box[0][j] = b.min.x; box[1][j] = b.min.y; box[2][j] = b.min.z;
+                box[3][j] = b.max.x; box[4][j] = b.max.y; box[5][j] = b.max.z;
+            }
+            int clipped;
+            project(box, matrix, rect, clipped);
+            for (std::size_t j = 0; j < lanes; j++)
+            {
+                bool hidden = !(clipped & (1 << j))
+                           && occluded(rect[0][j], rect[1][j], rect[2][j], rect[3][j], rect[4][j] * 0.5f + 0.5f);
+                if (!hidden) visible[kept++] = items[j];
+            }
+        }
+        mStats.tested   += visible.size();
+        mStats.rejected += visible.size() - kept;
+        visible.resize(kept);
+        mStats.test += milliseconds(start);
+    }
+
+    std::vector<GLuint> const & OcclusionCuller::query(glm::mat4 const & model, Bounds const * bounds,
+                                                       std::vector<std::uint32_t> const & visible)
+    {
+        mIssued.assign(visible.size(), 0);
+        if (!queries() || visible.empty()) return mIssued;
+
+        // Unit Cube Stretched over Each Box by the Proxy Shader
+        if (mVertexArray == 0)
+        {
+            const GLfloat corners[] = { 0, 0, 0,  1, 0, 0,  0, 1, 0,  1, 1, 0,
+                                        0, 0, 1,  1, 0, 1,  0, 1, 1,  1, 1, 1 };
+            const GLubyte faces[] = { 0, 2, 1, 1, 2, 3,  4, 5, 6, 5, 7, 6,  0, 1, 4, 1, 5, 4,
+                                      2, 6, 3, 3, 6, 7,  0, 4, 2, 2, 4, 6,  1, 3, 5, 3, 7, 5 };
+            glGenVertexArrays(1, & mVertexArray);
+            glBindVertexArray(mVertexArray);
+            glGenBuffers(1, & mVertexBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+            glGenBuffers(1, & mElementBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+        }
+
+        // Proxies Are Depth Tested but Write Nothing, and Both Faces Count
+        glm::mat4 matrix = mCurrent * model;
+        mProxy.activate();
+        mProxy.bind(mProxy.uniform(Shader::hash("transform")), matrix);
+        GLint lower = mProxy.uniform(Shader::hash("lower"));
+        GLint upper = mProxy.uniform(Shader::hash("upper"));
+        GLboolean culling = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_CULL_FACE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(mVertexArray);
+        for (std::size_t i = 0; i < visible.size(); i++)
+        {
+            auto & box = bounds[visible[i]];
+            if (reaches(matrix, box)) continue;
+            if (mUsed == mPool.size())
+            {
+                mPool.push_back(0);
+                glGenQueries(1, & mPool.back());
+            }
+            GLuint query = mPool[mUsed++];
+            mProxy.bind(lower, box.min);
+            mProxy.bind(upper, box.max);
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, query);
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, nullptr);
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            mIssued[i] = query;
+            mStats.queried++;
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        if (culling) glEnable(GL_CULL_FACE);
+        return mIssued;
+    }
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+// Local Headers
+#include "culling.hpp"
+#include "shader.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Draws Rejected by Occlusion and Time Spent Deciding, Since the Last Reset
+    struct OcclusionStats {
+        std::size_t tested    = 0;   // Boxes Tested Against the Depth Pyramid
+        std::size_t rejected  = 0;   // Hidden Behind the Pyramid, Never Submitted
+        std::size_t queried   = 0;   // Drawn Under Conditional Rendering
+        std::size_t discarded = 0;   // Queried Last Frame and Skipped by the GPU
+        double      build     = 0.0; // Milliseconds Reading Back Depth and Building the Pyramid
+        double      test      = 0.0;
+    };
+
+    // Max-Depth Pyramid Read Back from the GPU, Tested Against Boxes on the CPU Four at a Time,
+    // and Optionally Backed by Occlusion Queries on Proxy Boxes for Conditional Rendering.
+    //
+    // Depth Comes Either from the Whole Previous Frame, Read by capture() Once Everything Is
+    // Drawn, or from a Low-Resolution Pre-Pass of Chosen Occluders Drawn Between begin() and end().
+    // Readbacks Are Asynchronous, so Boxes Are Tested Against the Camera That Drew the Depth.
+    class OcclusionCuller
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor; the Size Is the Pyramid's Finest Level
+         OcclusionCuller(GLsizei width = 256, GLsizei height = 128);
+        ~OcclusionCuller();
+
+        // Draw Occluders Depth-Only into the Culler's Own Target, Then Read It Back
+        void begin();
+        void end(glm::mat4 const & viewProjection);
+
+        // Read Back Depth of the Bound Framebuffer, Drawn with a View-Projection Matrix
+        void capture(GLsizei width, GLsizei height, glm::mat4 const & viewProjection);
+
+        // Start a Frame Seen Through a View-Projection Matrix: Count Last Frame's Query Results
+        // and Rebuild the Pyramid from the Newest Finished Readback, Waiting for It if Asked.
+        // Returns Whether a Pyramid Is Available.
+        bool update(glm::mat4 const & viewProjection, bool wait = false);
+
+        // Drop Boxes Hidden Behind the Pyramid from a Sorted List of Indices; Boxes Are in the
+        // Space a Model Matrix Takes to the World
+        void cull(glm::mat4 const & model, Bounds const * bounds, std::vector<std::uint32_t> & visible);
+
+        // Issue One Query per Listed Box by Drawing It Invisibly; Returns a Query per Entry, or
+        // Zero Where the Box Reaches the Camera and Must Be Drawn. Changes the Bound Program.
+        std::vector<GLuint> const & query(glm::mat4 const & model, Bounds const * bounds,
+                                          std::vector<std::uint32_t> const & visible);
+
+        // Public Member Functions
+        void queries(bool enabled) { mQueries = enabled; }
+        bool queries() const { return mQueries && mProxy.ready(); }
+        glm::mat4 const & viewProjection() const { return mCurrent; }
+        OcclusionStats & stats() { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        OcclusionCuller(OcclusionCuller const &) = delete;
+        OcclusionCuller & operator=(OcclusionCuller const &) = delete;
+
+        // Depth Copied into a Pack Buffer, Waiting on a Fence
+        struct Readback {
+            GLuint buffer = 0;
+            GLsync fence  = nullptr;
+            GLsizei width = 0;
+            GLsizei height = 0;
+            std::size_t capacity = 0;
+            glm::mat4 matrix;
+        };
+
+        // Private Member Functions
+        void build(Readback const & readback, float const * depth);
+        bool occluded(float minX, float minY, float maxX, float maxY, float depth) const;
+
+        // Private Member Containers
+        std::vector<Readback> mReadbacks;
+        std::vector<float> mPyramid;       // Every Level, Finest First
+        std::vector<std::size_t> mLevels;  // Offset of Each Level in mPyramid
+        std::vector<GLuint> mPool;         // Query Objects, Reused Every Frame
+        std::vector<GLuint> mIssued;       // Queries Returned by the Last query()
+
+        // Private Member Variables
+        Shader mProxy;
+        GLsizei mWidth;
+        GLsizei mHeight;
+        glm::mat4 mCurrent;  // Camera of the Frame Being Drawn
+        glm::mat4 mMatrix;   // Camera That Drew the Pyramid's Depth
+        bool   mBuilt   = false;
+        bool   mQueries = false;
+        std::size_t mNext = 0;   // Readback Written by the Next capture()
+        std::size_t mUsed = 0;   // Queries Issued This Frame
+        GLuint mFramebuffer  = 0;
+        GLuint mRenderbuffer = 0;
+        GLuint mVertexArray  = 0;
+        GLuint mVertexBuffer = 0;
+        GLuint mElementBuffer = 0;
+        GLint  mBound = 0;       // Framebuffer and Viewport Restored by end()
+        GLint  mViewport[4];
+        OcclusionStats mStats;
+
+    };
+};
@@ -0,0 +1,217 @@
+// Local Headers
+#include "optimize.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Forsyth's Scoring Favours Recently Used Vertices and Vertices with Few Triangles Left
+        const int kCacheSize = 32;
+        float score(int position, unsigned int remaining)
+        {
+            if (remaining == 0) return -1.0f;
+            float value = 0.0f;
+            if (position >= 0)
+                value = position < 3 ? 0.75f : std::pow(1.0f - float(position - 3) / (kCacheSize - 3), 1.5f);
+            return value + 2.0f / std::sqrt(float(remaining));
+        }
+
+        // FIFO Cache Simulation Using Insertion Timestamps
+        struct Fifo {
+            Fifo(std::size_t vertices, std::size_t size) : stamps(vertices, 0), time(size + 1), size(size) {}
+            bool miss(GLuint vertex)
+            {
+                if (time - stamps[vertex] <= size) return false;
+                stamps[vertex] = time++;
+                return true;
+            }
+            std::vector<std::size_t> stamps;
+            std::size_t time, size;
+        };
+    }
+
+    CacheStats analyze(GLuint const * indices, std::size_t indexCount,
+                       std::size_t vertexCount, std::size_t cacheSize)
+    {
+        Fifo fifo(vertexCount, cacheSize);
+        std::vector<char> referenced(vertexCount, 0);
+        std::size_t misses = 0, unique = 0;
+        for (std::size_t i = 0; i < indexCount; i++)
+        {
+            misses += fifo.miss(indices[i]);
+            if (!referenced[indices[i]]) { referenced[indices[i]] = 1; unique++; }
+        }
+
+        CacheStats stats = { 0.0f, 0.0f, unique };
+        if (indexCount >= 3) stats.acmr = float(misses) / float(indexCount / 3);
+        if (unique > 0)      stats.atvr = float(misses) / float(unique);
+        return stats;
+    }
+
+    void optimizeVertexCache(GLuint * indices, std::size_t indexCount, std::size_t vertexCount)
+    {
+        std::size_t triangles = indexCount / 3;
+        if (triangles == 0) return;
+        std::vector<GLuint> source(indices, indices + indexCount);
+
+        // Build Vertex to Triangle Adjacency
+        std::vector<unsigned int> remaining(vertexCount, 0), offsets(vertexCount + 1, 0);
+        for (auto i : source) remaining[i]++;
+        std::partial_sum(remaining.begin(), remaining.end(), offsets.begin() + 1);
+        std::vector<unsigned int> adjacency(indexCount), fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indexCount; i++) adjacency[fill[source[i]]++] = static_cast<unsigned int>(i / 3);
+
+        // Seed Scores with Every Vertex Outside the Cache
+        std::vector<int> position(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount), triangleScore(triangles);
+        std::vector<char> emitted(triangles, 0);
+        for (std::size_t i = 0; i < vertexCount; i++) vertexScore[i] = score(-1, remaining[i]);
+        for (std::size_t i = 0; i < triangles; i++)
+            triangleScore[i] = vertexScore[source[3 * i]] + vertexScore[source[3 * i + 1]] + vertexScore[source[3 * i + 2]];
+
+        // Ties Always Resolve to the Lowest Index, Which Keeps the Output Deterministic
+        std::size_t best = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+        std::size_t cursor = 0, written = 0;
+        std::vector<GLuint> cache, next;
+        while (written < indexCount)
+        {
+            // Emit the Best Triangle and Retire It from Its Vertices
+            GLuint const * triangle = & source[3 * best];
+            emitted[best] = 1;
+            for (int i = 0; i < 3; i++)
+            {
+                GLuint vertex = triangle[i];
+                indices[written++] = vertex;
+                auto begin = adjacency.begin() + offsets[vertex];
+                auto end   = begin + remaining[vertex];
+                auto found = std::find(begin, end, static_cast<unsigned int>(best));
+                if (found == end) continue;
+                std::rotate(found, found + 1, end);
+                remaining[vertex]--;
+            }
+
+            // Move the Triangle's Vertices to the Front of the Simulated LRU Cache; a Degenerate
+            // Triangle Repeats a Vertex Anywhere Among Its Three, so Each Is Checked Against All
+            next.clear();
+            for (int i = 0; i < 3; i++)
+                if (std::find(next.begin(), next.end(), triangle[i]) == next.end()) next.push_back(triangle[i]);
+            for (auto i : cache)
+                if (std::find(triangle, triangle + 3, i) == triangle + 3) next.push_back(i);
+            for (std::size_t i = 0; i < next.size(); i++)
+                position[next[i]] = i < std::size_t(kCacheSize) ? int(i) : -1;
+
+            // Rescore Touched Vertices and Pick the Best Neighbouring Triangle
+            for (auto i : next) vertexScore[i] = score(position[i], remaining[i]);
+            float bestScore = -std::numeric_limits<float>::max();
+            best = triangles;
+            for (auto i : next)
+            for (unsigned int j = offsets[i]; j < offsets[i] + remaining[i]; j++)
+            {
+                auto t = adjacency[j];
+                triangleScore[t] = vertexScore[source[3 * t]] + vertexScore[source[3 * t + 1]] + vertexScore[source[3 * t + 2]];
+                if (triangleScore[t] > bestScore || (triangleScore[t] == bestScore && t < best))
+                { bestScore = triangleScore[t]; best = t; }
+            }
+            if (next.size() > std::size_t(kCacheSize)) next.resize(kCacheSize);
+            cache.swap(next);
+
+            // Nothing Adjacent Left: Continue with the Next Unemitted Triangle
+            if (best == triangles)
+            {
+                while (cursor < triangles && emitted[cursor]) cursor++;
+                best = cursor;
+                if (best == triangles) break;
+            }
+        }
+    }
+
+    void optimizeOverdraw(GLuint * indices, std::size_t indexCount,
+                          Vertex const * vertices, std::size_t vertexCount)
+    {
+        std::size_t triangles = indexCount / 3;
+        if (triangles == 0) return;
+
+        // Split Where the Cache Fully Restarts, so Reordering Clusters Costs Few Misses
+        Fifo fifo(vertexCount, 16);
+        std::vector<std::size_t> clusters;
+        for (std::size_t i = 0; i < triangles; i++)
+        {
+            int misses = fifo.miss(indices[3 * i]) + fifo.miss(indices[3 * i + 1]) + fifo.miss(indices[3 * i + 2]);
+            if (i == 0 || misses == 3) clusters.push_back(i);
+        }   clusters.push_back(triangles);
+
+        glm::vec3 center(0.0f);
+        for (std::size_t i = 0; i < vertexCount; i++) center += vertices[i].position;
+        if (vertexCount > 0) center /= float(vertexCount);
+
+        // Sort Key: How Far a Cluster Faces Away from the Mesh Center
+        std::vector<std::pair<float, std::size_t>> keys;
+        for (std::size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (std::size_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                auto & a = vertices[indices[3 * t + 0]].position;
+                auto & b = vertices[indices[3 * t + 1]].position;
+                auto & d = vertices[indices[3 * t + 2]].position;
+                auto face = glm::cross(b - a, d - a);
+                float weight = glm::length(face);
+                centroid += (a + b + d) * (weight / 3.0f);
+                normal   += face;
+                area     += weight;
+            }
+            float length = glm::length(normal);
+            float key = (area > 0.0f && length > 0.0f) ? glm::dot(centroid / area - center, normal / length) : 0.0f;
+            keys.push_back(std::make_pair(-key, c));
+        }   std::sort(keys.begin(), keys.end());
+
+        std::vector<GLuint> source(indices, indices + indexCount);
+        std::size_t written = 0;
+        for (auto & i : keys)
+        {
+            auto begin = source.begin() + 3 * clusters[i.second];
+            auto end   = source.begin() + 3 * clusters[i.second + 1];
+            written = std::copy(begin, end, indices + written) - indices;
+        }
+    }
+
+    std::size_t optimizeVertexFetch(Vertex * vertices, GLuint * indices,
+                                    std::size_t indexCount, std::size_t vertexCount)
+    {
+        std::vector<GLuint> remap(vertexCount, ~GLuint(0));
+        GLuint next = 0;
+        for (std::size_t i = 0; i < indexCount; i++)
+        {
+            if (remap[indices[i]] == ~GLuint(0)) remap[indices[i]] = next++;
+            indices[i] = remap[indices[i]];
+        }
+
+        std::vector<Vertex> source(vertices, vertices + vertexCount);
+        for (std::size_t i = 0; i < vertexCount; i++)
+            if (remap[i] != ~GLuint(0)) vertices[remap[i]] = source[i];
+        return next;
+    }
+
+    OptimizeReport optimize(std::vector<Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        OptimizeReport report;
+        report.triangles = indices.size() / 3;
+        report.before = report.after = analyze(indices.data(), indices.size(), vertices.size());
+
+        // Only Pure Triangle Lists Can Be Reordered
+        if (indices.empty() || indices.size() % 3 != 0) return report;
+        optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+        optimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+        vertices.resize(optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.size()));
+        report.after = analyze(indices.data(), indices.size(), vertices.size());
+        return report;
+    }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Post-Transform Cache Efficiency of an Index Buffer
+    struct CacheStats {
+        float acmr; // Misses per Triangle; 0.5 Is Ideal for Grids, 3.0 Is Worst
+        float atvr; // Misses per Referenced Vertex; 1.0 Is Ideal
+        std::size_t vertices; // Distinct Vertices the Indices Reference
+    };
+
+    struct OptimizeReport {
+        CacheStats  before;
+        CacheStats  after;
+        std::size_t triangles;
+    };
+
+    // Simulate a FIFO Post-Transform Cache of the Given Size
+    CacheStats analyze(GLuint const * indices, std::size_t indexCount,
+                       std::size_t vertexCount, std::size_t cacheSize = 16);
+
+    // Reorder Triangles for Cache Locality (Forsyth's Linear-Speed Algorithm)
+    void optimizeVertexCache(GLuint * indices, std::size_t indexCount, std::size_t vertexCount);
+
+    // Reorder Cache-Friendly Triangle Clusters so Outward-Facing Ones Draw First
+    void optimizeOverdraw(GLuint * indices, std::size_t indexCount,
+                          Vertex const * vertices, std::size_t vertexCount);
+
+    // Renumber Vertices in First-Use Order, Dropping Unreferenced Ones; Returns the New Count
+    std::size_t optimizeVertexFetch(Vertex * vertices, GLuint * indices,
+                                    std::size_t indexCount, std::size_t vertexCount);
+
+    // Run All Three Passes; Deterministic, so Results Are Safe to Cache
+    OptimizeReport optimize(std::vector<Vertex> & vertices, std::vector<GLuint> & indices);
+};
@@ -0,0 +1,236 @@
+// Local Headers
+#include "physics.hpp"
+
+// System Headers
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Latest Slot Index, Plus a Flag Set While It Holds a Step the Reader Has Not Seen
+        const unsigned int kIndex = 3;
+        const unsigned int kFresh = 4;
+
+        // Catch Up at Most This Many Steps at Once; Beyond That, Skip Ahead Instead of Spiralling
+        const int kMaxSteps = 4;
+    }
+
+    Physics::Physics(double rate, glm::vec3 const & gravity)
+        : mConfiguration(new btDefaultCollisionConfiguration())
+        , mDispatcher(new btCollisionDispatcher(mConfiguration.get()))
+        , mBroadphase(new btDbvtBroadphase())
+        , mSolver(new btSequentialImpulseConstraintSolver())
+        , mWorld(new btDiscreteDynamicsWorld(mDispatcher.get(), mBroadphase.get(), mSolver.get(), mConfiguration.get()))
+        , mBack(1), mLatest(2), mRunning(false), mSteps(0), mDropped(0), mLast(0.0), mWorst(0.0)
+        , mFront(0), mAlpha(1.0)
+        , mEpoch(Clock::now()), mStep(1.0 / rate)
+    {
+        mWorld->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
+    }
+
+    Physics::~Physics()
+    {
+        stop();
+        drain();
+        for (auto & i : mBodies) mWorld->removeRigidBody(i.get());
+        mBodies.clear();
+        mWorld.reset();
+        mSolver.reset();
+        mBroadphase.reset();
+        mDispatcher.reset();
+        mConfiguration.reset();
+    }
+
+    btCollisionShape * Physics::convexHull(Mesh const & mesh)
+    {
+        std::vector<Vertex> vertices; std::vector<GLuint> indices;
+        mesh.geometry(vertices, indices);
+        if (vertices.empty()) return nullptr;
+
+        // Reduce the Point Cloud to a Small Hull; Support Mapping Is Linear in Its Size
+        btConvexHullShape cloud;
+        for (auto & i : vertices) cloud.addPoint(btVector3(i.position.x, i.position.y, i.position.z), false);
+        cloud.recalcLocalAabb();
+        btShapeHull hull(& cloud);
+        hull.buildHull(cloud.getMargin());
+        return adopt(new btConvexHullShape(reinterpret_cast<btScalar const *>(hull.getVertexPointer()),
+                                           hull.numVertices(), sizeof(btVector3)));
+    }
+
+    btCollisionShape * Physics::triangleMesh(Mesh const & mesh)
+    {
+        std::vector<Vertex> vertices; std::vector<GLuint> indices;
+        mesh.geometry(vertices, indices);
+        if (indices.size() < 3) return nullptr;
+
+        // Bullet Keeps Its Own Copy, so the Mesh May Release Geometry Afterwards
+        std::unique_ptr<btTriangleMesh> triangles(new btTriangleMesh(true, false));
+        triangles->preallocateVertices(static_cast<int>(vertices.size()));
+        triangles->preallocateIndices(static_cast<int>(indices.size()));
+        for (auto & i : vertices)
+            triangles->findOrAddVertex(btVector3(i.position.x, i.position.y, i.position.z), false);
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+            triangles->addTriangleIndices(indices[i], indices[i + 1], indices[i + 2]);
+        auto shape = adopt(new btBvhTriangleMeshShape(triangles.get(), true));
+        mMeshes.push_back(std::move(triangles));
+        return shape;
+    }
+
+    btCollisionShape * Physics::adopt(btCollisionShape * shape)
+    {
+        mShapes.push_back(std::unique_ptr<btCollisionShape>(shape));
+        return shape;
+    }
+
+    std::size_t Physics::add(btCollisionShape * shape, float mass, glm::mat4 const & transform)
+    {
+        // Concave Shapes Cannot Be Dynamic in Bullet
+        if (shape->isConcave()) mass = 0.0f;
+        btVector3 inertia(0.0f, 0.0f, 0.0f);
+        if (mass > 0.0f) shape->calculateLocalInertia(mass, inertia);
+        btRigidBody::btRigidBodyConstructionInfo info(mass, nullptr, shape, inertia);
+        btScalar matrix[16];
+        for (int i = 0; i < 16; i++) matrix[i] = glm::value_ptr(transform)[i];
+        info.m_startWorldTransform.setFromOpenGLMatrix(matrix);
+
+        // The World Is Not Thread-Safe, so the Physics Thread Inserts Queued Bodies
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPending.push_back(std::unique_ptr<btRigidBody>(new btRigidBody(info)));
+        mInitial.push_back(transform);
+        return mInitial.size() - 1;
+    }
+
+    void Physics::drain()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto & i : mPending)
+        {
+            mWorld->addRigidBody(i.get());
+            mBodies.push_back(std::move(i));
+        }   mPending.clear();
+    }
+
+    void Physics::start()
+    {
+        if (mRunning) return;
+        mRunning = true;
+        mThread = std::thread(& Physics::run, this);
+    }
+
+    void Physics::stop()
+    {
+        mRunning = false;
+        if (mThread.joinable()) mThread.join();
+    }
+
+    double Physics::seconds(Clock::time_point time) const
+    {
+        return std::chrono::duration<double>(time - mEpoch).count();
+    }
+
+    void Physics::run()
+    {
+        auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(mStep));
+        auto next = Clock::now();
+        while (mRunning)
+        {
+            drain();
+            int steps = 0;
+            while (next <= Clock::now() && steps < kMaxSteps)
+            {
+                auto start = Clock::now();
+                mWorld->stepSimulation(static_cast<btScalar>(mStep), 0);
+                capture();
+                double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                mLast = elapsed;
+                if (elapsed > mWorst) mWorst = elapsed;
+                mSteps++;
+                steps++;
+                next += step;
+            }
+
+            auto stamp = next - step;
+
+            // Fell Too Far Behind: Drop the Backlog Rather Than Stall Every Later Frame
+            auto now = Clock::now();
+            if (next <= now)
+            {
+                auto behind = static_cast<std::uint64_t>((now - next) / step) + 1;
+                mDropped += behind;
+                next += step * behind;
+            }
+
+            if (steps > 0) publish(seconds(stamp));
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    void Physics::capture()
+    {
+        // The Previous Step Becomes the Interpolation Start
+        std::swap(mPositions[0], mPositions[1]);
+        std::swap(mRotations[0], mRotations[1]);
+        mPositions[1].resize(mBodies.size());
+        mRotations[1].resize(mBodies.size());
+        for (std::size_t i = 0; i < mBodies.size(); i++)
+        {
+            auto & transform = mBodies[i]->getWorldTransform();
+            auto & origin    = transform.getOrigin();
+            auto   rotation  = transform.getRotation();
+            mPositions[1][i] = glm::vec3(origin.x(), origin.y(), origin.z());
+            mRotations[1][i] = glm::quat(rotation.w(), rotation.x(), rotation.y(), rotation.z());
+        }
+
+        // Bodies Added This Step Start Where They Are
+        for (std::size_t i = mPositions[0].size(); i < mBodies.size(); i++)
+        {
+            mPositions[0].push_back(mPositions[1][i]);
+            mRotations[0].push_back(mRotations[1][i]);
+        }
+    }
+
+    void Physics::publish(double time)
+    {
+        // Fill the Back Slot, Then Swap It with the Latest; Vectors Keep Their Capacity
+        auto & snapshot = mSnapshots[mBack];
+        for (int i = 0; i < 2; i++)
+        {
+            snapshot.positions[i].assign(mPositions[i].begin(), mPositions[i].end());
+            snapshot.rotations[i].assign(mRotations[i].begin(), mRotations[i].end());
+        }   snapshot.time = time;
+        mBack = mLatest.exchange(mBack | kFresh, std::memory_order_acq_rel) & kIndex;
+    }
+
+    void Physics::sync()
+    {
+        if (mLatest.load(std::memory_order_acquire) & kFresh)
+            mFront = mLatest.exchange(mFront, std::memory_order_acq_rel) & kIndex;
+
+        // Render One Step Behind, Blending Toward the Newest State
+        double alpha = (seconds(Clock::now()) - mSnapshots[mFront].time) / mStep;
+        mAlpha = std::min(std::max(alpha, 0.0), 1.0);
+    }
+
+    glm::mat4 Physics::transform(std::size_t body) const
+    {
+        auto & snapshot = mSnapshots[mFront];
+        if (body >= snapshot.positions[1].size()) return mInitial[body];
+        float alpha = static_cast<float>(mAlpha);
+        auto position = glm::mix(snapshot.positions[0][body], snapshot.positions[1][body], alpha);
+        auto rotation = glm::slerp(snapshot.rotations[0][body], snapshot.rotations[1][body], alpha);
+        return glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation);
+    }
+
+    Physics::Stats Physics::stats() const
+    {
+        Stats stats = { mSteps.load(), mDropped.load(), mLast.load(), mWorst.load() };
+        return stats;
+    }
+};
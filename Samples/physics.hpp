@@ -0,0 +1,116 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// System Headers
+#include <btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Standard Headers
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Bullet World Stepped at a Fixed Rate on Its Own Thread; the Render Thread Reads
+    // Interpolated Transforms from a Lock-Free Triple Buffer and Never Waits on a Step
+    class Physics
+    {
+    public:
+
+        // Steps Are Counted Since start(); Times in Milliseconds
+        struct Stats {
+            std::uint64_t steps;
+            std::uint64_t dropped; // Steps Skipped to Catch Up After a Stall
+            double last;
+            double worst;
+        };
+
+        // Implement Custom Constructor and Destructor
+         explicit Physics(double rate = 120.0, glm::vec3 const & gravity = glm::vec3(0.0f, -9.81f, 0.0f));
+        ~Physics();
+
+        // Shapes Are Owned Here and May Be Shared by Many Bodies; Meshes Must Keep Geometry
+        btCollisionShape * convexHull(Mesh const & mesh);
+        btCollisionShape * triangleMesh(Mesh const & mesh);
+        btCollisionShape * adopt(btCollisionShape * shape);
+
+        // Queue a Body for the Next Step; Zero Mass or a Triangle Mesh Makes It Static
+        std::size_t add(btCollisionShape * shape, float mass, glm::mat4 const & transform);
+
+        // Public Member Functions
+        void start();
+        void stop();
+        Stats stats() const;
+
+        // Render Thread: Adopt the Newest Published Step, Then Read Interpolated Transforms
+        void sync();
+        glm::mat4 transform(std::size_t body) const;
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        // Body States at the Two Most Recent Steps; time Is When the Newer One Applies
+        struct Snapshot {
+            std::vector<glm::vec3> positions[2];
+            std::vector<glm::quat> rotations[2];
+            double time = 0.0;
+        };
+
+        // Disable Copying and Assignment
+        Physics(Physics const &) = delete;
+        Physics & operator=(Physics const &) = delete;
+
+        // Private Member Functions
+        void run();
+        void drain();
+        void capture();
+        void publish(double time);
+        double seconds(Clock::time_point time) const;
+
+        // Bullet World; Touched Only by the Physics Thread Once Started
+        std::unique_ptr<btDefaultCollisionConfiguration> mConfiguration;
+        std::unique_ptr<btCollisionDispatcher> mDispatcher;
+        std::unique_ptr<btBroadphaseInterface> mBroadphase;
+        std::unique_ptr<btSequentialImpulseConstraintSolver> mSolver;
+        std::unique_ptr<btDiscreteDynamicsWorld> mWorld;
+        std::vector<std::unique_ptr<btRigidBody>> mBodies;
+        std::vector<glm::vec3> mPositions[2];
+        std::vector<glm::quat> mRotations[2];
+        unsigned int mBack;
+
+        // Shared Between Threads
+        std::vector<std::unique_ptr<btRigidBody>> mPending;
+        Snapshot mSnapshots[3];
+        std::atomic<unsigned int> mLatest;
+        std::atomic<bool> mRunning;
+        std::atomic<std::uint64_t> mSteps;
+        std::atomic<std::uint64_t> mDropped;
+        std::atomic<double> mLast;
+        std::atomic<double> mWorst;
+        std::mutex mMutex;
+        std::thread mThread;
+
+        // Render Thread State
+        std::vector<std::unique_ptr<btCollisionShape>> mShapes;
+        std::vector<std::unique_ptr<btTriangleMesh>> mMeshes;
+        std::vector<glm::mat4> mInitial;
+        unsigned int mFront;
+        double mAlpha;
+
+        // Private Member Variables
+        Clock::time_point mEpoch;
+        double mStep;
+
+    };
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+// System Headers
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MIRAGE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// Standard Headers
+#include <chrono>
+
+// Define Namespace
+namespace Mirage
+{
+    // Stats Are Timed on the Wall Clock, in Milliseconds
+    typedef std::chrono::steady_clock Clock;
+    inline double milliseconds(Clock::time_point start)
+    { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+};
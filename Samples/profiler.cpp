@@ -0,0 +1,211 @@
+// Local Headers
+#include "profiler.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        const std::uint64_t kNone = ~std::uint64_t(0);
+
+        // Scope Names Are Code Literals, but Keep the JSON Valid Regardless
+        std::string escape(char const * name)
+        {
+            std::string escaped;
+            for (char const * i = name; * i; i++)
+            {
+                if (* i == '"' || * i == '\\') escaped += '\\';
+                if (static_cast<unsigned char>(* i) >= 0x20) escaped += * i;
+            }   return escaped;
+        }
+    }
+
+    Profiler & Profiler::global()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void Profiler::enable(bool enabled)
+    {
+        // Allocate Everything Up Front, so Frames Never Allocate
+        if (enabled && mFrames.empty())
+        {
+            mFrames.resize(kFrames);
+            mQueries.resize(kLatency * kSamples);
+            mIssued.assign(kLatency * kSamples, 0);
+            mSlotFrames.assign(kLatency, kNone);
+            glGenQueries(static_cast<GLsizei>(mQueries.size()), mQueries.data());
+        }   mEnabled = enabled;
+    }
+
+    double Profiler::now() const
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - mEpoch).count();
+    }
+
+    void Profiler::beginFrame()
+    {
+        if (!mEnabled) return;
+
+        // Reuse the Query Slot of kLatency Frames Ago; Results Not Yet Ready Are Dropped
+        std::size_t slot = mFrameIndex % kLatency;
+        resolve(slot, false);
+        mSlotFrames[slot] = mFrameIndex;
+
+        auto & frame = mFrames[mFrameIndex % kFrames];
+        frame.index = mFrameIndex;
+        frame.begin = now();
+        frame.end   = frame.begin;
+        frame.count = 0;
+        mInFrame = true;
+    }
+
+    void Profiler::endFrame()
+    {
+        if (!mInFrame) return;
+        mFrames[mFrameIndex % kFrames].end = now();
+        mFrameIndex++;
+        mInFrame = false;
+    }
+
+    void Profiler::push(char const * name, bool gpu)
+    {
+        // Scopes Outside a Frame or Past the Per-Frame Limit Still Nest, but Record Nothing
+        std::size_t index = kSamples;
+        auto & frame = mFrames[mFrameIndex % kFrames];
+        if (mInFrame && frame.count < kSamples)
+        {
+            index = frame.count++;
+            Sample sample = { name, static_cast<std::uint32_t>(mDepth), now(), 0.0, -1.0 };
+            frame.samples[index] = sample;
+
+            // GL_TIME_ELAPSED Queries Cannot Nest, so Only the Outermost GPU Scope Is Timed
+            if (gpu && mGpuScope == kSamples)
+            {
+                std::size_t query = (mFrameIndex % kLatency) * kSamples + index;
+                glBeginQuery(GL_TIME_ELAPSED, mQueries[query]);
+                mIssued[query] = 1;
+                mGpuScope = index;
+            }
+        }
+        else if (mInFrame) mDropped++;
+
+        if (mDepth < kSamples) mStack[mDepth] = index;
+        mDepth++;
+    }
+
+    void Profiler::pop()
+    {
+        if (mDepth == 0) return;
+        mDepth--;
+        std::size_t index = mDepth < kSamples ? mStack[mDepth] : kSamples;
+        if (index == kSamples) return;
+
+        mFrames[mFrameIndex % kFrames].samples[index].end = now();
+        if (mGpuScope == index)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            mGpuScope = kSamples;
+        }
+    }
+
+    void Profiler::resolve(std::size_t slot, bool wait)
+    {
+        if (mSlotFrames.empty() || mSlotFrames[slot] == kNone) return;
+        auto & frame = mFrames[mSlotFrames[slot] % kFrames];
+        for (std::size_t i = 0; i < kSamples; i++)
+        {
+            std::size_t query = slot * kSamples + i;
+            if (!mIssued[query]) continue;
+            GLint available = GL_TRUE;
+            if (!wait) glGetQueryObjectiv(mQueries[query], GL_QUERY_RESULT_AVAILABLE, & available);
+            if (available)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(mQueries[query], GL_QUERY_RESULT, & elapsed);
+                if (frame.index == mSlotFrames[slot]) frame.samples[i].gpu = elapsed / 1.0e6;
+            }   mIssued[query] = 0;
+        }   mSlotFrames[slot] = kNone;
+    }
+
+    std::size_t Profiler::frames() const
+    {
+        // The Frame Being Recorded Overwrites the Oldest One Once the Ring Is Full
+        std::size_t retained = mInFrame ? kFrames - 1 : kFrames;
+        return static_cast<std::size_t>(std::min<std::uint64_t>(mFrameIndex, retained));
+    }
+
+    Profiler::Frame const & Profiler::frame(std::size_t index) const
+    {
+        return mFrames[(mFrameIndex - frames() + index) % kFrames];
+    }
+
+    bool Profiler::exportTrace(std::string const & filename)
+    {
+        for (std::size_t i = 0; i < mSlotFrames.size(); i++)
+            if (!mInFrame || i != mFrameIndex % kLatency) resolve(i, true);
+
+        // Chrome Trace Event Format: CPU Scopes on Thread 1, GPU Durations on Thread 2
+        std::ofstream fd(filename, std::ios::trunc);
+        char line[512];
+        fd << "{\"traceEvents\":[\n";
+        fd << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        fd << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+        for (std::size_t i = 0; i < frames(); i++)
+        {
+            auto & frame = this->frame(i);
+            snprintf(line, sizeof(line), ",\n{\"name\":\"frame %llu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                     static_cast<unsigned long long>(frame.index), frame.begin * 1000.0, (frame.end - frame.begin) * 1000.0);
+            fd << line;
+            for (std::size_t j = 0; j < frame.count; j++)
+            {
+                auto & sample = frame.samples[j];
+                auto name = escape(sample.name);
+                snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                         name.c_str(), sample.begin * 1000.0, (sample.end - sample.begin) * 1000.0);
+                fd << line;
+                if (sample.gpu < 0.0) continue;
+                snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+                         name.c_str(), sample.begin * 1000.0, sample.gpu * 1000.0);
+                fd << line;
+            }
+        }
+        fd << "\n]}\n";
+        return static_cast<bool>(fd);
+    }
+
+    bool Profiler::exportCsv(std::string const & filename)
+    {
+        for (std::size_t i = 0; i < mSlotFrames.size(); i++)
+            if (!mInFrame || i != mFrameIndex % kLatency) resolve(i, true);
+
+        // One Row per Scope; Empty GPU Column When Not Measured
+        std::ofstream fd(filename, std::ios::trunc);
+        char line[512];
+        fd << "frame,name,depth,begin_ms,cpu_ms,gpu_ms\n";
+        for (std::size_t i = 0; i < frames(); i++)
+        {
+            auto & frame = this->frame(i);
+            snprintf(line, sizeof(line), "%llu,frame,0,%.4f,%.4f,\n",
+                     static_cast<unsigned long long>(frame.index), frame.begin, frame.end - frame.begin);
+            fd << line;
+            for (std::size_t j = 0; j < frame.count; j++)
+            {
+                auto & sample = frame.samples[j];
+                int length = snprintf(line, sizeof(line), "%llu,%s,%u,%.4f,%.4f,",
+                    static_cast<unsigned long long>(frame.index), sample.name,
+                    sample.depth + 1, sample.begin, sample.end - sample.begin);
+                if (sample.gpu >= 0.0 && length > 0 && length < static_cast<int>(sizeof(line)))
+                    snprintf(line + length, sizeof(line) - length, "%.4f", sample.gpu);
+                fd << line << "\n";
+            }
+        }
+        return static_cast<bool>(fd);
+    }
+};
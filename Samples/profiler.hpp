@@ -0,0 +1,128 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Build with -DMIRAGE_PROFILE=0 to Compile Every Profile Scope Out
+#ifndef MIRAGE_PROFILE
+#define MIRAGE_PROFILE 1
+#endif
+
+#define MIRAGE_CONCAT_(a, b) a##b
+#define MIRAGE_CONCAT(a, b) MIRAGE_CONCAT_(a, b)
+#if MIRAGE_PROFILE
+#define MIRAGE_PROFILE_SCOPE(name) Mirage::Profiler::Scope MIRAGE_CONCAT(profileScope, __LINE__)(name)
+#define MIRAGE_PROFILE_GPU(name)   Mirage::Profiler::Scope MIRAGE_CONCAT(profileScope, __LINE__)(name, true)
+#else
+#define MIRAGE_PROFILE_SCOPE(name)
+#define MIRAGE_PROFILE_GPU(name)
+#endif
+
+// Define Namespace
+namespace Mirage
+{
+    // Records Nested CPU Scopes and GPU Timer Queries per Frame; GL Thread Only
+    class Profiler
+    {
+    public:
+
+        static const std::size_t kFrames  = 256; // Frames Retained for Export
+        static const std::size_t kSamples = 64;  // Scopes Recorded per Frame
+        static const std::size_t kLatency = 4;   // Frames Before GPU Results Are Read Back
+
+        // One Timed Scope; Names Must Be String Literals or Otherwise Outlive the Profiler
+        struct Sample {
+            char const *  name;
+            std::uint32_t depth;
+            double begin; // Milliseconds Since the Profiler Was Created
+            double end;
+            double gpu;   // Milliseconds of GPU Time; Negative if Not Measured or Not Ready
+        };
+
+        struct Frame {
+            std::uint64_t index;
+            double begin;
+            double end;
+            std::size_t count;
+            Sample samples[kSamples];
+        };
+
+        // Times the Enclosing Block; Costs One Branch While the Profiler Is Disabled
+        class Scope
+        {
+        public:
+             explicit Scope(char const * name, bool gpu = false) : mActive(global().enabled())
+             { if (mActive) global().push(name, gpu); }
+            ~Scope() { if (mActive) global().pop(); }
+
+        private:
+
+            // Disable Copying and Assignment
+            Scope(Scope const &) = delete;
+            Scope & operator=(Scope const &) = delete;
+
+            // Private Member Variables
+            bool mActive;
+
+        };
+
+        // Implement Default Constructor
+        Profiler() : mEpoch(Clock::now()) {}
+
+        // Process-Wide Profiler, Disabled Until enable(true)
+        static Profiler & global();
+
+        // Public Member Functions
+        void enable(bool enabled);
+        bool enabled() const { return mEnabled; }
+        void beginFrame();
+        void endFrame();
+        void push(char const * name, bool gpu = false);
+        void pop();
+
+        // Retained Frames, Oldest First
+        std::size_t frames() const;
+        Frame const & frame(std::size_t index) const;
+        std::size_t dropped() const { return mDropped; }
+
+        // Export Retained Frames; Waits for Outstanding GPU Results First
+        bool exportTrace(std::string const & filename);
+        bool exportCsv(std::string const & filename);
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        // Disable Copying and Assignment
+        Profiler(Profiler const &) = delete;
+        Profiler & operator=(Profiler const &) = delete;
+
+        // Private Member Functions
+        double now() const;
+        void resolve(std::size_t slot, bool wait);
+
+        // Private Member Containers
+        std::vector<Frame> mFrames;
+        std::vector<GLuint> mQueries;           // kLatency Slots of kSamples Queries
+        std::vector<char> mIssued;              // Whether Each Query Awaits Its Result
+        std::vector<std::uint64_t> mSlotFrames; // Frame Whose Queries Each Slot Holds
+        std::size_t mStack[kSamples];
+
+        // Private Member Variables
+        Clock::time_point mEpoch;
+        std::uint64_t mFrameIndex = 0;
+        std::size_t mDepth    = 0;
+        std::size_t mGpuScope = kSamples;
+        std::size_t mDropped  = 0;
+        bool mEnabled = false;
+        bool mInFrame = false;
+
+    };
+};
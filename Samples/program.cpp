@@ -0,0 +1,183 @@
+// Local Headers
+#include "cache.hpp"
+#include "platform.hpp"
+#include "program.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Binary File Header; the Blob Follows Directly
+        struct Header {
+            char   magic[4];
+            GLenum format;
+            GLint  length;
+        };
+    }
+
+    ProgramCache & ProgramCache::global()
+    {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    bool ProgramCache::build(GLuint program, std::vector<ShaderStage> const & stages)
+    {
+        // Try the Cached Binary First, Then Fall Back to Compiling from Source
+        if (restore(program, stages)) return true;
+        submit(program, stages);
+        return finish(program, stages);
+    }
+
+    bool ProgramCache::restore(GLuint program, std::vector<ShaderStage> const & stages)
+    {
+        // The Driver May Still Reject a Binary, Such as One from an Older Driver Build
+        std::string file = supported() ? filename(stages) : "";
+        if (file.empty()) return false;
+        auto start = Clock::now();
+        if (!load(program, file)) return false;
+        mStats.hits++;
+        mStats.load += milliseconds(start);
+        return true;
+    }
+
+    bool ProgramCache::supported() const
+    {
+        GLint formats = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, & formats);
+        return formats > 0;
+    }
+
+    std::string ProgramCache::filename(std::vector<ShaderStage> const & stages) const
+    {
+        // Any Source or Driver Change Produces a Different Key
+        std::uint64_t key = MeshCache::hash(nullptr, 0);
+        for (auto & i : stages)
+        {
+            key = MeshCache::hash(& i.type, sizeof(i.type), key);
+            key = MeshCache::hash(i.source.data(), i.source.size(), key);
+        }
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            auto string = reinterpret_cast<char const *>(glGetString(name));
+            if (string) key = MeshCache::hash(string, std::strlen(string), key);
+        }
+
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        return mDirectory + "/program-" + hex + ".bin";
+    }
+
+    bool ProgramCache::load(GLuint program, std::string const & filename)
+    {
+        MappedFile file(filename);
+        Header header;
+        if (!file.valid() || file.size() < sizeof(Header)) return false;
+        std::memcpy(& header, file.data(), sizeof(Header));
+        if (std::memcmp(header.magic, "MRGP", 4) != 0
+            || header.length <= 0
+            || sizeof(Header) + header.length > file.size()) return false;
+
+        GLint status = GL_FALSE;
+        glProgramBinary(program, header.format, file.data() + sizeof(Header), header.length);
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        if (status == GL_FALSE) mStats.rejected++;
+        return status == GL_TRUE;
+    }
+
+    void ProgramCache::store(GLuint program, std::string const & filename)
+    {
+        Header header = { { 'M', 'R', 'G', 'P' }, 0, 0 };
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, & header.length);
+        if (header.length <= 0) return;
+        std::unique_ptr<char[]> blob(new char[header.length]);
+        glGetProgramBinary(program, header.length, nullptr, & header.format, blob.get());
+
+        // Write Beside the Final Name, so a Crash Never Leaves a Torn Binary
+        std::string temporary = filename + ".tmp";
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        fd.write(reinterpret_cast<char const *>(& header), sizeof(Header));
+        fd.write(blob.get(), header.length);
+        fd.close();
+        if (!fd) { std::remove(temporary.c_str()); return; }
+    #ifdef _WIN32
+        std::remove(filename.c_str());
+    #endif
+        std::rename(temporary.c_str(), filename.c_str());
+    }
+
+    void ProgramCache::submit(GLuint program, std::vector<ShaderStage> const & stages)
+    {
+        // Querying Status Here Would Make the Driver Finish Each Compile Before the Next
+        mStats.misses++;
+        mSubmitted[program] = Clock::now();
+        if (supported()) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        for (auto & i : stages)
+        {
+            // Shaders Deleted While Attached Live Until finish() Detaches Them
+            const char * source = i.source.c_str();
+            auto shader = glCreateShader(i.type);
+            glShaderSource(shader, 1, & source, nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }   glLinkProgram(program);
+    }
+
+    bool ProgramCache::finish(GLuint program, std::vector<ShaderStage> const & stages)
+    {
+        GLint status, length, attached = 0;
+        glGetProgramiv(program, GL_ATTACHED_SHADERS, & attached);
+        std::vector<GLuint> shaders(attached);
+        if (attached > 0) glGetAttachedShaders(program, attached, nullptr, shaders.data());
+        for (auto shader : shaders)
+        {
+            // Display the Build Log on Error, Named After the Stage of the Same Type
+            glGetShaderiv(shader, GL_COMPILE_STATUS, & status);
+            if (status == GL_FALSE)
+            {
+                GLint type = GL_NONE;
+                glGetShaderiv(shader, GL_SHADER_TYPE, & type);
+                auto stage = std::find_if(stages.begin(), stages.end(),
+                    [&](ShaderStage const & i) { return static_cast<GLint>(i.type) == type; });
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & length);
+                std::unique_ptr<char[]> buffer(new char[std::max(length, 1)]());
+                glGetShaderInfoLog(shader, length, nullptr, buffer.get());
+                fprintf(stderr, "%s\n%s", stage != stages.end() ? stage->name.c_str() : "", buffer.get());
+            }
+        }
+
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        if (status == GL_FALSE)
+        {
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, & length);
+            std::unique_ptr<char[]> buffer(new char[length]);
+            glGetProgramInfoLog(program, length, nullptr, buffer.get());
+            fprintf(stderr, "%s", buffer.get());
+        }
+
+        // The Build Is Over Once Its Status Is Known; Storing the Binary Is Not Part of It
+        auto submitted = mSubmitted.find(program);
+        if (submitted != mSubmitted.end())
+        {
+            mStats.compile += milliseconds(submitted->second);
+            mSubmitted.erase(submitted);
+        }
+
+        // Detach so the Shader Objects Are Actually Freed, Then Refresh the Cache
+        for (auto i : shaders) glDetachShader(program, i);
+        if (status == GL_TRUE && supported()) store(program, filename(stages));
+        return status == GL_TRUE;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // One Shader Stage of a Program, Given as GLSL Source
+    struct ShaderStage {
+        GLenum type;
+        std::string name;
+        std::string source;
+    };
+
+    // Caches Linked Program Binaries on Disk, Keyed by Source and Driver
+    class ProgramCache
+    {
+    public:
+
+        // Cache Hits Versus Source Builds, Timed in Milliseconds; Each Miss Counts from submit()
+        // to finish(), so Builds Overlapping on the Driver's Threads Each Add Their Full Latency
+        struct Stats {
+            std::size_t hits     = 0;
+            std::size_t misses   = 0;
+            std::size_t rejected = 0;
+            double load    = 0.0;
+            double compile = 0.0;
+        };
+
+        // Implement Custom Constructor
+        explicit ProgramCache(std::string const & directory = ".") : mDirectory(directory) {}
+
+        // Process-Wide Cache Rooted in the Working Directory
+        static ProgramCache & global();
+
+        // Link Stages into a Program, Preferring a Cached Binary; Returns Link Status
+        bool build(GLuint program, std::vector<ShaderStage> const & stages);
+
+        // The Steps of build(), for Callers Overlapping Many Compiles: restore() Tries the
+        // Cached Binary, submit() Issues Compiles and the Link Without Waiting on Either,
+        // and finish() Reports Errors, Then Caches the Binary; Both Return Link Status
+        bool restore(GLuint program, std::vector<ShaderStage> const & stages);
+        void submit(GLuint program, std::vector<ShaderStage> const & stages);
+        bool finish(GLuint program, std::vector<ShaderStage> const & stages);
+
+        // Public Member Functions
+        void directory(std::string const & directory) { mDirectory = directory; }
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        ProgramCache(ProgramCache const &) = delete;
+        ProgramCache & operator=(ProgramCache const &) = delete;
+
+        // Private Member Functions
+        bool supported() const;
+        std::string filename(std::vector<ShaderStage> const & stages) const;
+        bool load(GLuint program, std::string const & filename);
+        void store(GLuint program, std::string const & filename);
+
+        // Private Member Containers
+        std::map<GLuint, std::chrono::steady_clock::time_point> mSubmitted;
+
+        // Private Member Variables
+        std::string mDirectory;
+        Stats mStats;
+
+    };
+};
@@ -0,0 +1,92 @@
+// Local Headers
+#include "quantize.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    Quantization bounds(Vertex const * vertices, std::size_t count)
+    {
+        glm::vec3 lower( std::numeric_limits<float>::max());
+        glm::vec3 upper(-std::numeric_limits<float>::max());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            lower = glm::min(lower, vertices[i].position);
+            upper = glm::max(upper, vertices[i].position);
+        }
+
+        // Flat Axes Still Need a Non-Zero Scale
+        Quantization quantization;
+        if (count == 0) lower = upper = glm::vec3(0.0f);
+        quantization.offset = lower;
+        quantization.scale  = glm::max(upper - lower, glm::vec3(1e-20f));
+        return quantization;
+    }
+
+    Quantization bounds(Quantization const & a, Quantization const & b)
+    {
+        Quantization quantization;
+        quantization.offset = glm::min(a.offset, b.offset);
+        quantization.scale  = glm::max(a.offset + a.scale, b.offset + b.scale) - quantization.offset;
+        return quantization;
+    }
+
+    void encode(Vertex const * vertices, std::size_t count,
+                Quantization const & quantization, PackedVertex * packed)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto position = (vertices[i].position - quantization.offset) / quantization.scale;
+            for (int j = 0; j < 3; j++)
+                packed[i].position[j] = static_cast<GLushort>(
+                    std::lround(glm::clamp(position[j], 0.0f, 1.0f) * 65535.0f));
+            packed[i].position[3] = 0;
+            packed[i].normal = snorm(vertices[i].normal);
+            packed[i].uv[0]  = half(vertices[i].uv.x);
+            packed[i].uv[1]  = half(vertices[i].uv.y);
+        }
+    }
+
+    GLushort half(float value)
+    {
+        // Round to Nearest Even; Overflow Becomes Infinity, Tiny Values Become Subnormal
+        std::uint32_t bits; std::memcpy(& bits, & value, sizeof(bits));
+        std::uint32_t sign = (bits >> 16) & 0x8000;
+        std::uint32_t magnitude = bits & 0x7fffffff;
+        if (magnitude >= 0x7f800000) // Infinity or NaN
+            return static_cast<GLushort>(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+        if (magnitude >= 0x477ff000) return static_cast<GLushort>(sign | 0x7c00);
+        if (magnitude <  0x38800000) // Subnormal Half
+        {
+            if (magnitude < 0x33000000) return static_cast<GLushort>(sign);
+            std::uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+            std::uint32_t shift = 126 - (magnitude >> 23);
+            std::uint32_t result = mantissa >> shift;
+            std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+            std::uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (result & 1))) result++;
+            return static_cast<GLushort>(sign | result);
+        }
+        std::uint32_t result = (magnitude - 0x38000000) >> 13;
+        std::uint32_t remainder = magnitude & 0x1fff;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) result++;
+        return static_cast<GLushort>(sign | result);
+    }
+
+    GLuint snorm(glm::vec3 const & normal)
+    {
+        // Pack x, y, z into Consecutive 10-Bit Fields Starting at the Low Bit
+        GLuint packed = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            auto value = static_cast<int>(std::lround(glm::clamp(normal[i], -1.0f, 1.0f) * 511.0f));
+            packed |= (static_cast<GLuint>(value) & 0x3ff) << (10 * i);
+        }   return packed;
+    }
+};
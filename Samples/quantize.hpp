@@ -0,0 +1,36 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+
+// Define Namespace
+namespace Mirage
+{
+    // Packed Vertex Format: 16 Bytes Instead of 32
+    struct PackedVertex {
+        GLushort position[4]; // Unsigned Normalized Within the Mesh Bounds; w Is Padding
+        GLuint   normal;      // Signed Normalized GL_INT_2_10_10_10_REV
+        GLushort uv[2];       // Half Floats
+    };
+
+    // Maps Normalized Positions Back to Object Space: offset + scale * p
+    struct Quantization {
+        glm::vec3 offset;
+        glm::vec3 scale;
+    };
+
+    // Compute the Dequantization Transform Covering Every Vertex
+    Quantization bounds(Vertex const * vertices, std::size_t count);
+    Quantization bounds(Quantization const & a, Quantization const & b);
+
+    // Encode Vertices Against a Previously Computed Transform
+    void encode(Vertex const * vertices, std::size_t count,
+                Quantization const & quantization, PackedVertex * packed);
+
+    // Scalar Encoders
+    GLushort half(float value);
+    GLuint   snorm(glm::vec3 const & normal);
+};
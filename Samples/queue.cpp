@@ -0,0 +1,164 @@
+// Local Headers
+#include "queue.hpp"
+
+// System Headers
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+
+// Define Namespace
+namespace Mirage
+{
+    void StateCache::invalidate()
+    {
+        // Zero Is a Valid Binding, so Use a Name GL Never Hands Out
+        mProgram = mVertexArray = mIndirectBuffer = mActiveUnit = ~GLuint(0);
+        for (GLuint i = 0; i < kUnits; i++) { mTextures[i] = ~GLuint(0); mTargets[i] = GL_NONE; }
+    }
+
+    void StateCache::program(GLuint program)
+    {
+        if (program == mProgram) { mStats.skipped++; return; }
+        glUseProgram(mProgram = program);
+        mStats.programs++;
+    }
+
+    void StateCache::vertexArray(GLuint vertexArray)
+    {
+        if (vertexArray == mVertexArray) { mStats.skipped++; return; }
+        glBindVertexArray(mVertexArray = vertexArray);
+        mStats.vertexArrays++;
+    }
+
+    void StateCache::indirectBuffer(GLuint buffer)
+    {
+        if (buffer == mIndirectBuffer) { mStats.skipped++; return; }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer = buffer);
+        mStats.buffers++;
+    }
+
+    void StateCache::texture(GLuint unit, GLenum target, GLuint texture)
+    {
+        if (unit < kUnits && mTextures[unit] == texture && mTargets[unit] == target) { mStats.skipped++; return; }
+        if (unit != mActiveUnit) glActiveTexture(GL_TEXTURE0 + (mActiveUnit = unit));
+        glBindTexture(target, texture);
+        if (unit < kUnits) { mTextures[unit] = texture; mTargets[unit] = target; }
+        mStats.textures++;
+    }
+
+    std::uint64_t RenderQueue::key(unsigned int pass, GLuint program, std::uint32_t material,
+                                   GLuint vertexArray, float depth)
+    {
+        // Depth Is Clamped to [0, 1]; Nearer Draws Sort First Within Equal State
+        auto quantized = static_cast<std::uint64_t>(std::min(std::max(depth, 0.0f), 1.0f) * 1048575.0f);
+        return (std::uint64_t(pass        & 0xF)    << 60)
+             | (std::uint64_t(program     & 0xFFF)  << 48)
+             | (std::uint64_t(material    & 0xFFFF) << 32)
+             | (std::uint64_t(vertexArray & 0xFFF)  << 20)
+             | quantized;
+    }
+
+    void RenderQueue::push(RenderCommand const & command)
+    {
+        mCommands.push_back(command);
+        mSorted = false;
+    }
+
+    std::uint32_t RenderQueue::uniforms(DrawUniforms const & uniforms)
+    {
+        mUniforms.push_back(uniforms);
+        return static_cast<std::uint32_t>(mUniforms.size() - 1);
+    }
+
+    std::uint32_t RenderQueue::material(TextureBinding const * bindings, std::size_t count)
+    {
+        auto first = static_cast<std::uint32_t>(mBindings.size());
+        mBindings.insert(mBindings.end(), bindings, bindings + count);
+        return first;
+    }
+
+    void RenderQueue::clear()
+    {
+        // Containers Keep Their Capacity, so Steady-State Frames Do Not Allocate
+        mCommands.clear();
+        mUniforms.clear();
+        mBindings.clear();
+        mSorted = false;
+    }
+
+    void RenderQueue::sort()
+    {
+        std::size_t count = mCommands.size();
+        mOrder.resize(count);
+        mScratch.resize(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            mOrder[i].key   = mCommands[i].key;
+            mOrder[i].index = static_cast<std::uint32_t>(i);
+        }
+
+        // Least Significant Digit Radix Sort, One Byte per Pass; Stable, so Equal Keys Keep Queue Order
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            std::size_t histogram[257] = { 0 };
+            for (auto & i : mOrder) histogram[((i.key >> shift) & 0xFF) + 1]++;
+
+            // Every Key Shares This Byte, so the Pass Would Not Move Anything
+            if (std::find(histogram + 1, histogram + 257, count) != histogram + 257) continue;
+            for (int i = 0; i < 256; i++) histogram[i + 1] += histogram[i];
+            for (auto & i : mOrder) mScratch[histogram[(i.key >> shift) & 0xFF]++] = i;
+            mOrder.swap(mScratch);
+        }   mSorted = true;
+    }
+
+    void RenderQueue::execute()
+    {
+        if (!mSorted) sort();
+
+        // Anything May Have Run Since the Last Frame, so Start from Unknown State and Fresh Counts
+        mState.invalidate();
+        mState.resetStats();
+        for (auto & entry : mOrder)
+        {
+            auto & command = mCommands[entry.index];
+            auto & uniforms = mUniforms[command.uniforms];
+            mState.program(command.program);
+            for (std::uint32_t i = 0; i < command.textures; i++)
+            {
+                auto & binding = mBindings[command.material + i];
+                mState.texture(binding.unit, binding.target, binding.texture);
+            }
+            mState.vertexArray(command.vertexArray);
+
+            // Uniforms Are Per Draw and Always Differ, so They Bypass the Cache
+            if (uniforms.modelLocation >= 0)
+                glUniformMatrix4fv(uniforms.modelLocation, 1, GL_FALSE, glm::value_ptr(uniforms.model));
+            if (uniforms.offsetLocation >= 0)
+                glUniform3fv(uniforms.offsetLocation, 1, glm::value_ptr(uniforms.positionOffset));
+            if (uniforms.scaleLocation >= 0)
+                glUniform3fv(uniforms.scaleLocation, 1, glm::value_ptr(uniforms.positionScale));
+            if (uniforms.nodeLocation >= 0)
+                glUniformMatrix4fv(uniforms.nodeLocation, 1, GL_FALSE, glm::value_ptr(uniforms.node));
+
+            if (command.indirect)
+            {
+                mState.indirectBuffer(command.indirect);
+                glMultiDrawElementsIndirect(GL_TRIANGLES, command.indexType,
+                    reinterpret_cast<GLvoid const *>(command.offset), command.count, 0);
+            }
+            else if (command.draw >= 0)
+            {
+                // The Array Behind Attribute 3 Advances per Instance, so Without baseInstance It
+                // Would Read Record 0; Switch It to a Constant for This Draw Alone
+                glDisableVertexAttribArray(3);
+                glVertexAttribI1ui(3, static_cast<GLuint>(command.draw));
+                glDrawElementsBaseVertex(GL_TRIANGLES, command.count, command.indexType,
+                    reinterpret_cast<GLvoid const *>(command.offset), command.baseVertex);
+                glEnableVertexAttribArray(3);
+            }
+            else glDrawElementsBaseVertex(GL_TRIANGLES, command.count, command.indexType,
+                    reinterpret_cast<GLvoid const *>(command.offset), command.baseVertex);
+        }
+    }
+};
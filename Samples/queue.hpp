@@ -0,0 +1,144 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Remembers Bound GL State and Skips Calls That Would Not Change It
+    class StateCache
+    {
+    public:
+
+        // Calls Issued Versus Calls Skipped Since the Last Reset
+        struct Stats {
+            std::size_t programs     = 0;
+            std::size_t vertexArrays = 0;
+            std::size_t textures     = 0;
+            std::size_t buffers      = 0;
+            std::size_t skipped      = 0;
+            std::size_t changes() const { return programs + vertexArrays + textures + buffers; }
+        };
+
+        // Implement Default Constructor
+        StateCache() { invalidate(); }
+
+        // Forget Cached State After Code Outside the Cache Touched GL
+        void invalidate();
+
+        // Public Member Functions
+        void program(GLuint program);
+        void vertexArray(GLuint vertexArray);
+        void texture(GLuint unit, GLenum target, GLuint texture);
+        void indirectBuffer(GLuint buffer);
+        Stats const & stats() const { return mStats; }
+        void resetStats() { mStats = Stats(); }
+
+    private:
+
+        // Units Beyond This Are Bound Without Caching
+        static const GLuint kUnits = 32;
+
+        // Private Member Variables
+        GLuint mProgram;
+        GLuint mVertexArray;
+        GLuint mIndirectBuffer;
+        GLuint mActiveUnit;
+        GLuint mTextures[kUnits];
+        GLenum mTargets[kUnits];
+        Stats  mStats;
+
+    };
+
+    // Per-Draw Uniforms, with Locations Resolved When the Draw Is Queued
+    struct DrawUniforms {
+        glm::mat4 model;
+        glm::vec3 positionOffset;
+        glm::vec3 positionScale;
+        GLint modelLocation;
+        GLint offsetLocation;
+        GLint scaleLocation;
+        glm::mat4 node;    // Sub-Mesh Placement Within the Model
+        GLint nodeLocation;
+    };
+
+    // One Texture Binding of a Material
+    struct TextureBinding {
+        GLuint unit;
+        GLenum target;
+        GLuint texture;
+    };
+
+    // Compact Draw; Indirect Draws Read count Commands at offset in the Indirect Buffer. Merged
+    // Draws Issued One by One Carry Their Draw Index, Which Indirect Draws Get from baseInstance.
+    struct RenderCommand {
+        std::uint64_t key;
+        GLuint   program;
+        GLuint   vertexArray;
+        GLuint   indirect;
+        GLenum   indexType;
+        GLsizei  count;
+        GLintptr offset;
+        GLint    baseVertex;
+        std::uint32_t material; // Index of the First TextureBinding
+        std::uint32_t textures; // Number of TextureBindings
+        std::uint32_t uniforms; // Index into DrawUniforms
+        GLint    draw;          // Constant for Attribute 3, or -1 to Leave It Alone
+    };
+
+    // Collects Draws for a Frame, Radix-Sorts Them by Key and Executes Them Through a StateCache
+    class RenderQueue
+    {
+    public:
+
+        // Key Layout, Most Significant First: Pass 4, Program 12, Material 16, Vertex Array 12, Depth 20
+        static std::uint64_t key(unsigned int pass, GLuint program, std::uint32_t material,
+                                 GLuint vertexArray, float depth);
+
+        // Implement Default Constructor
+        RenderQueue() : mSorted(false) {}
+
+        // Queue a Draw, and the Uniforms and Textures It Refers To
+        void push(RenderCommand const & command);
+        std::uint32_t uniforms(DrawUniforms const & uniforms);
+        std::uint32_t material(TextureBinding const * bindings, std::size_t count);
+
+        // Public Member Functions
+        void clear();
+        void sort();
+        void execute();
+        std::size_t size() const { return mCommands.size(); }
+        StateCache & state() { return mState; }
+
+    private:
+
+        // Disable Copying and Assignment
+        RenderQueue(RenderQueue const &) = delete;
+        RenderQueue & operator=(RenderQueue const &) = delete;
+
+        // Sort Keys Paired with Command Indices, so Radix Passes Stay Sequential
+        struct Entry {
+            std::uint64_t key;
+            std::uint32_t index;
+        };
+
+        // Private Member Containers
+        std::vector<RenderCommand> mCommands;
+        std::vector<DrawUniforms> mUniforms;
+        std::vector<TextureBinding> mBindings;
+        std::vector<Entry> mOrder;
+        std::vector<Entry> mScratch;
+
+        // Private Member Variables
+        StateCache mState;
+        bool mSorted;
+
+    };
+};
@@ -0,0 +1,193 @@
+// Local Headers
+#include "platform.hpp"
+#include "scene.hpp"
+#include "threadpool.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Nodes per Task; Large Enough That Scheduling Costs Less Than the Matrix Products
+        const std::uint32_t kChunk = 1024;
+
+        // Nodes One Task Recomputed
+        struct Span {
+            std::uint32_t first;
+            std::uint32_t last;
+            std::size_t   count;
+        };
+    }
+
+    SceneGraph::SceneGraph()
+        : mDepths(1, 0)
+        , mFirstDirty(none)
+        , mUploadFirst(none)
+        , mUploadLast(0)
+        , mCapacity(0)
+        , mBuffer(0)
+        , mTexture(0)
+        , mOrdered(true)
+    {}
+
+    SceneGraph::~SceneGraph()
+    {
+        if (mTexture) glDeleteTextures(1, & mTexture);
+        if (mBuffer)  glDeleteBuffers(1, & mBuffer);
+    }
+
+    std::uint32_t SceneGraph::add(std::uint32_t parent, glm::mat4 const & local)
+    {
+        auto node = static_cast<std::uint32_t>(size());
+        mLocal.push_back(local);
+        mWorld.push_back(local);
+        mParent.push_back(parent);
+        mDirty.push_back(1);
+        mFirstDirty = std::min(mFirstDirty, node);
+
+        // Appending Stays Breadth-First While Each Node Joins the Deepest Level or Starts the Next
+        if (!mOrdered) return node;
+        std::size_t levels = mDepths.size() - 1;
+        std::size_t depth = parent == none ? 0 : static_cast<std::size_t>(
+            std::upper_bound(mDepths.begin(), mDepths.end() - 1, parent) - mDepths.begin());
+             if (depth + 1 == levels) mDepths.back()++;
+        else if (depth == levels) mDepths.push_back(mDepths.back() + 1);
+        else mOrdered = false;
+        return node;
+    }
+
+    std::vector<std::uint32_t> SceneGraph::build()
+    {
+        // Children of Each Node in Compressed Rows, Kept in Insertion Order
+        std::size_t count = size();
+        std::vector<std::uint32_t> offsets(count + 1, 0), children(count);
+        for (auto i : mParent) if (i != none) offsets[i + 1]++;
+        for (std::size_t i = 0; i < count; i++) offsets[i + 1] += offsets[i];
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < count; i++)
+            if (mParent[i] != none) children[fill[mParent[i]]++] = static_cast<std::uint32_t>(i);
+
+        // Visit Level by Level, Recording Where Each Depth Ends
+        std::vector<std::uint32_t> order;
+        order.reserve(count);
+        for (std::size_t i = 0; i < count; i++) if (mParent[i] == none) order.push_back(static_cast<std::uint32_t>(i));
+        mDepths.assign(1, 0);
+        for (std::size_t begin = 0, end = order.size(); begin < end; begin = end, end = order.size())
+        {
+            for (std::size_t i = begin; i < end; i++)
+                order.insert(order.end(), children.begin() + offsets[order[i]], children.begin() + offsets[order[i] + 1]);
+            mDepths.push_back(static_cast<std::uint32_t>(end));
+        }
+
+        // Permute Every Array Together
+        std::vector<std::uint32_t> remap(count);
+        for (std::size_t i = 0; i < count; i++) remap[order[i]] = static_cast<std::uint32_t>(i);
+        std::vector<glm::mat4> local(count);
+        std::vector<std::uint32_t> parent(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            local[i]  = mLocal[order[i]];
+            parent[i] = mParent[order[i]] == none ? none : remap[mParent[order[i]]];
+        }
+        mLocal.swap(local);
+        mParent.swap(parent);
+        mWorld.assign(mLocal.begin(), mLocal.end());
+        mDirty.assign(count, 1);
+        mFirstDirty = count > 0 ? 0 : none;
+        mOrdered = true;
+        return remap;
+    }
+
+    void SceneGraph::transform(std::uint32_t node, glm::mat4 const & local)
+    {
+        mLocal[node] = local;
+        mDirty[node] = 1;
+        mFirstDirty  = std::min(mFirstDirty, node);
+    }
+
+    std::size_t SceneGraph::update()
+    {
+        // Nodes Added Out of Order Are Sorted Here; Callers Holding Ids Should build() Themselves
+        if (!mOrdered) build();
+        auto start = Clock::now();
+        mStats.nodes   = size();
+        mStats.updated = 0;
+        if (mFirstDirty == none) { mStats.update = milliseconds(start); return 0; }
+
+        // Levels Above the Shallowest Dirty Node Cannot Change; Each Level Below Depends Only on the Last
+        std::size_t level = static_cast<std::size_t>(
+            std::upper_bound(mDepths.begin(), mDepths.end() - 1, mFirstDirty) - mDepths.begin()) - 1;
+        std::uint32_t first = none, last = 0;
+        std::vector<Span> spans;
+        for (; level + 1 < mDepths.size(); level++)
+        {
+            std::uint32_t begin = mDepths[level], end = mDepths[level + 1];
+            spans.assign((end - begin + kChunk - 1) / kChunk, Span { none, 0, 0 });
+            ThreadPool::global().parallel(spans.size(), [&](std::size_t chunk) {
+                Span span = { none, 0, 0 };
+                std::uint32_t from = begin + static_cast<std::uint32_t>(chunk) * kChunk;
+                std::uint32_t to   = std::min(end, from + kChunk);
+                for (std::uint32_t i = from; i < to; i++)
+                {
+                    auto parent = mParent[i];
+                    if (parent != none && mDirty[parent]) mDirty[i] = 1;
+                    if (!mDirty[i]) continue;
+                    mWorld[i] = parent == none ? mLocal[i] : mWorld[parent] * mLocal[i];
+                    span.first = std::min(span.first, i);
+                    span.last  = i;
+                    span.count++;
+                }   spans[chunk] = span;
+            });
+            for (auto & i : spans)
+            {
+                if (i.count == 0) continue;
+                first = std::min(first, i.first);
+                last  = std::max(last, i.last);
+                mStats.updated += i.count;
+            }
+        }
+
+        // Flags Are Read Across Levels, so Clear Them Only Once Every Level Is Done
+        std::fill(mDirty.begin() + first, mDirty.begin() + last + 1, 0);
+        mUploadFirst = std::min(mUploadFirst, first);
+        mUploadLast  = std::max(mUploadLast, last);
+        mFirstDirty  = none;
+        mStats.update = milliseconds(start);
+        return mStats.updated;
+    }
+
+    void SceneGraph::upload()
+    {
+        mStats.uploaded = 0;
+        if (mUploadFirst == none) return;
+        if (mBuffer == 0)
+        {
+            glGenBuffers(1, & mBuffer);
+            glGenTextures(1, & mTexture);
+        }
+
+        // Grow to Fit Every Node at Once; Otherwise Send Only the Changed Span
+        glBindBuffer(GL_TEXTURE_BUFFER, mBuffer);
+        if (mCapacity < size())
+        {
+            mCapacity = size();
+            mStats.uploaded = mCapacity * sizeof(glm::mat4);
+            glBufferData(GL_TEXTURE_BUFFER, mStats.uploaded, mWorld.data(), GL_DYNAMIC_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, mTexture);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mBuffer);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+        else
+        {
+            mStats.uploaded = (mUploadLast - mUploadFirst + 1) * sizeof(glm::mat4);
+            glBufferSubData(GL_TEXTURE_BUFFER, mUploadFirst * sizeof(glm::mat4), mStats.uploaded, & mWorld[mUploadFirst]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        mUploadFirst = none;
+        mUploadLast  = 0;
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Transform Hierarchy Stored as Parallel Arrays in Breadth-First Order, so Every Parent
+    // Precedes Its Children and Each Depth Is a Contiguous Range That Updates in Parallel
+    class SceneGraph
+    {
+    public:
+
+        // Parent of Root Nodes
+        static const std::uint32_t none = 0xFFFFFFFF;
+
+        // Work Done by the Last update() and upload()
+        struct Stats {
+            std::size_t nodes    = 0;
+            std::size_t updated  = 0;   // World Matrices Recomputed
+            std::size_t uploaded = 0;   // Bytes Sent to the GPU
+            double      update   = 0.0; // Milliseconds
+        };
+
+        // Implement Custom Constructor and Destructor
+         SceneGraph();
+        ~SceneGraph();
+
+        // Append a Node Under an Existing One; Ids Hold Until the Next build()
+        std::uint32_t add(std::uint32_t parent, glm::mat4 const & local);
+
+        // Sort Breadth-First and Mark Everything Dirty; Returns Each Old Id's New Id
+        std::vector<std::uint32_t> build();
+
+        // Replace a Node's Local Transform; Its Subtree Is Recomputed by the Next update()
+        void transform(std::uint32_t node, glm::mat4 const & local);
+
+        // Recompute Dirty Subtrees Level by Level; Returns the Number of Nodes Updated
+        std::size_t update();
+
+        // Copy the Span of World Matrices Changed Since the Last Upload into the Buffer Texture
+        void upload();
+
+        // Public Member Functions
+        glm::mat4 const & local(std::uint32_t node) const { return mLocal[node]; }
+        glm::mat4 const & world(std::uint32_t node) const { return mWorld[node]; }
+        std::uint32_t parent(std::uint32_t node) const { return mParent[node]; }
+        std::size_t size() const { return mParent.size(); }
+        GLuint texture() const { return mTexture; } // Four RGBA32F Texels per Node
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        SceneGraph(SceneGraph const &) = delete;
+        SceneGraph & operator=(SceneGraph const &) = delete;
+
+        // Private Member Containers
+        std::vector<glm::mat4> mLocal;
+        std::vector<glm::mat4> mWorld;
+        std::vector<std::uint32_t> mParent;
+        std::vector<unsigned char> mDirty;
+        std::vector<std::uint32_t> mDepths; // First Node of Each Depth, Then the Node Count
+
+        // Private Member Variables
+        std::uint32_t mFirstDirty;  // Lowest Id Marked Since the Last update()
+        std::uint32_t mUploadFirst; // Span Waiting for upload()
+        std::uint32_t mUploadLast;
+        std::size_t mCapacity;
+        GLuint mBuffer;
+        GLuint mTexture;
+        bool   mOrdered;
+        Stats  mStats;
+
+    };
+};
@@ -1,77 +1,252 @@
 // Local Headers
+#include "compiler.hpp"
 #include "shader.hpp"
 
 // Standard Headers
+#include <algorithm>
 #include <cassert>
-#include <fstream>
+#include <cstdio>
+#include <map>
 #include <memory>
 
 // Define Namespace
 namespace Mirage
 {
+    namespace
+    {
+        // Shader Files Are Named Relative to This Directory
+        const std::string kDirectory = PROJECT_SOURCE_DIR "/Mirage/Shaders/";
+    }
+
+    Shader::~Shader()
+    {
+        // Also Forget Its Link Result, so a Program Reusing the Name Is Not Reported Ready
+        ShaderCompiler::global().cancel(mProgram);
+        glDeleteProgram(mProgram);
+    }
+
     Shader & Shader::activate()
     {
         glUseProgram(mProgram);
         return *this;
     }
 
-    void Shader::bind(unsigned int location, float value) { glUniform1f(location, value); }
-    void Shader::bind(unsigned int location, glm::mat4 const & matrix)
+    void Shader::bind(unsigned int location, float value) const { glUniform1f(location, value); }
+    void Shader::bind(unsigned int location, glm::vec3 const & vector) const
+    { glUniform3fv(location, 1, glm::value_ptr(vector)); }
+    void Shader::bind(unsigned int location, glm::mat4 const & matrix) const
     { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix)); }
 
     Shader & Shader::attach(std::string const & filename)
     {
-        // Load GLSL Shader Source from File
-        std::string path = PROJECT_SOURCE_DIR "/Mirage/Shaders/";
-        std::ifstream fd(path + filename);
-        auto src = std::string(std::istreambuf_iterator<char>(fd),
-                              (std::istreambuf_iterator<char>()));
-
-        // Create a Shader Object
-        const char * source = src.c_str();
-        auto shader = create(filename);
-        glShaderSource(shader, 1, & source, nullptr);
-        glCompileShader(shader);
-        glGetShaderiv(shader, GL_COMPILE_STATUS, & mStatus);
-
-        // Display the Build Log on Error
-        if (mStatus == false)
-        {
-            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & mLength);
-            std::unique_ptr<char[]> buffer(new char[mLength]);
-            glGetShaderInfoLog(shader, mLength, nullptr, buffer.get());
-            fprintf(stderr, "%s\n%s", filename.c_str(), buffer.get());
-        }
-
-        // Attach the Shader and Free Allocated Memory
-        glAttachShader(mProgram, shader);
-        glDeleteShader(shader);
+        // Record the Stage; Its Source Is Read by link() or, Off This Thread, by compile()
+        ShaderStage stage;
+        stage.type = type(filename);
+        stage.name = filename;
+        mStages.push_back(stage);
         return *this;
     }
 
-    GLuint Shader::create(std::string const & filename)
+    GLenum Shader::type(std::string const & filename)
     {
         auto index = filename.rfind(".");
         auto ext = filename.substr(index + 1);
-             if (ext == "comp") return glCreateShader(GL_COMPUTE_SHADER);
-        else if (ext == "frag") return glCreateShader(GL_FRAGMENT_SHADER);
-        else if (ext == "geom") return glCreateShader(GL_GEOMETRY_SHADER);
-        else if (ext == "vert") return glCreateShader(GL_VERTEX_SHADER);
-        else                    return false;
+             if (ext == "comp") return GL_COMPUTE_SHADER;
+        else if (ext == "frag") return GL_FRAGMENT_SHADER;
+        else if (ext == "geom") return GL_GEOMETRY_SHADER;
+        else if (ext == "vert") return GL_VERTEX_SHADER;
+        else                    return GL_NONE;
+    }
+
+    GLuint Shader::create(std::string const & filename)
+    {
+        auto stage = type(filename);
+        return stage == GL_NONE ? 0 : glCreateShader(stage);
     }
 
     Shader & Shader::link()
     {
-        glLinkProgram(mProgram);
-        glGetProgramiv(mProgram, GL_LINK_STATUS, & mStatus);
-        if(mStatus == false)
-        {
-            glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, & mLength);
-            std::unique_ptr<char[]> buffer(new char[mLength]);
-            glGetProgramInfoLog(mProgram, mLength, nullptr, buffer.get());
-            fprintf(stderr, "%s", buffer.get());
-        }
+        // Reuse a Cached Program Binary When the Driver Accepts It
+        ShaderCompiler::load(mStages, kDirectory);
+        complete(ProgramCache::global().build(mProgram, mStages));
         assert(mStatus == true);
         return *this;
     }
+
+    Shader & Shader::compile()
+    {
+        ShaderCompiler::global().submit(mProgram, mStages, kDirectory, this);
+        mStages.clear();
+        return *this;
+    }
+
+    void Shader::complete(bool linked)
+    {
+        mStages.clear();
+        mStatus = linked;
+        mReady  = true;
+        if (linked) reflect();
+    }
+
+    Shader::Uniform const * Shader::find(std::uint32_t hash) const
+    {
+        auto i = std::lower_bound(mUniforms.begin(), mUniforms.end(), hash,
+            [](Uniform const & uniform, std::uint32_t key) { return uniform.hash < key; });
+        return (i != mUniforms.end() && i->hash == hash) ? & * i : nullptr;
+    }
+
+    Shader::Block const * Shader::block(std::uint32_t hash) const
+    {
+        for (auto & i : mBlocks) if (i.hash == hash) return & i;
+        return nullptr;
+    }
+
+    void Shader::reflect()
+    {
+        // Blocks with the Same Name Share a Binding Point Across Every Program, Until the
+        // Driver's Binding Points Run Out; Later Names Are Left Without One
+        static std::map<std::uint32_t, GLuint> bindings;
+        GLint count = 0, length = 0, limit = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, & limit);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_BLOCKS, & count);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, & length);
+        std::vector<char> name(std::max(length, 1));
+        mBlocks.clear();
+        for (GLint i = 0; i < count; i++)
+        {
+            Block block;
+            glGetActiveUniformBlockName(mProgram, i, length, nullptr, name.data());
+            glGetActiveUniformBlockiv(mProgram, i, GL_UNIFORM_BLOCK_DATA_SIZE, & block.size);
+            block.hash    = hash(name.data());
+            block.index   = static_cast<GLuint>(i);
+            auto found    = bindings.find(block.hash);
+            if (found == bindings.end() && bindings.size() >= static_cast<std::size_t>(limit))
+            {
+                fprintf(stderr, "Uniform Block %s Exceeds %d Binding Points\n", name.data(), limit);
+                continue;
+            }
+            if (found == bindings.end()) found = bindings.insert(std::make_pair(block.hash, GLuint(bindings.size()))).first;
+            block.binding = found->second;
+            glUniformBlockBinding(mProgram, block.index, block.binding);
+            mBlocks.push_back(block);
+        }
+
+        // Record Every Active Uniform, Dropping the "[0]" Suffix of Arrays
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, & count);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, & length);
+        name.resize(std::max(length, 1));
+        mUniforms.clear();
+        for (GLint i = 0; i < count; i++)
+        {
+            Uniform uniform;
+            GLuint index = static_cast<GLuint>(i);
+            glGetActiveUniform(mProgram, index, length, nullptr, & uniform.count, & uniform.type, name.data());
+            glGetActiveUniformsiv(mProgram, 1, & index, GL_UNIFORM_BLOCK_INDEX, & uniform.block);
+            glGetActiveUniformsiv(mProgram, 1, & index, GL_UNIFORM_OFFSET, & uniform.offset);
+            if (auto bracket = std::strchr(name.data(), '[')) * bracket = '\0';
+            uniform.hash     = hash(name.data());
+            uniform.location = glGetUniformLocation(mProgram, name.data());
+            uniform.unit     = -1;
+            mUniforms.push_back(uniform);
+        }   std::stable_sort(mUniforms.begin(), mUniforms.end(),
+                [](Uniform const & a, Uniform const & b) { return a.hash < b.hash; });
+
+        // Colliding Hashes Would Make Lookups Ambiguous; Keep the First Reflected and Report the Rest
+        for (std::size_t i = 1; i < mUniforms.size(); i++)
+            if (mUniforms[i].hash == mUniforms[i - 1].hash)
+                fprintf(stderr, "Uniforms of Program %u Share Hash %08x; Dropping Location %d\n",
+                        mProgram, mUniforms[i].hash, mUniforms[i].location);
+        mUniforms.erase(std::unique(mUniforms.begin(), mUniforms.end(),
+            [](Uniform const & a, Uniform const & b) { return a.hash == b.hash; }), mUniforms.end());
+
+        // Give Every Sampler a Fixed Texture Unit, so Draws Never Set Sampler Uniforms; Arrays Take
+        // Consecutive Units, and Samplers Past the Driver's Limit Are Left Unassigned
+        GLint previous, units = 0; GLint unit = 0;
+        std::vector<GLint> consecutive;
+        glGetIntegerv(GL_CURRENT_PROGRAM, & previous);
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, & units);
+        glUseProgram(mProgram);
+        for (auto & i : mUniforms)
+        {
+            switch (i.type)
+            {
+                // Every Sampler Type of GL 4.0 Core
+                case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+                case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+                case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY:
+                case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+                case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_SAMPLER_BUFFER:
+                case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+                case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+                case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+                case GL_INT_SAMPLER_2D_RECT: case GL_INT_SAMPLER_BUFFER:
+                case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+                case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+                case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+                case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+                case GL_UNSIGNED_INT_SAMPLER_2D_RECT: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+                case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+                    if (i.location < 0) break;
+                    if (unit + i.count > units)
+                    {
+                        fprintf(stderr, "Sampler %08x of Program %u Exceeds %d Texture Units\n", i.hash, mProgram, units);
+                        break;
+                    }
+                    consecutive.resize(i.count);
+                    for (GLint j = 0; j < i.count; j++) consecutive[j] = unit + j;
+                    glUniform1iv(i.location, i.count, consecutive.data());
+                    i.unit = unit;
+                    unit += i.count;
+                    break;
+
+                // Plain Values Are Written by bind() or a UniformBuffer
+                case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+                case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+                case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+                case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+                case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+                case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+                case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2:
+                case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+                case GL_DOUBLE_MAT2: case GL_DOUBLE_MAT3: case GL_DOUBLE_MAT4:
+                case GL_DOUBLE_MAT2x3: case GL_DOUBLE_MAT2x4: case GL_DOUBLE_MAT3x2:
+                case GL_DOUBLE_MAT3x4: case GL_DOUBLE_MAT4x2: case GL_DOUBLE_MAT4x3:
+                    break;
+
+                // Anything Else, Such as an Image Unit, Gets No Texture Unit
+                default:
+                    fprintf(stderr, "Uniform %08x of Program %u Has Unhandled Type 0x%04x\n",
+                            i.hash, mProgram, i.type);
+                    break;
+            }
+        }   glUseProgram(static_cast<GLuint>(previous));
+    }
+
+    UniformBuffer::UniformBuffer(Shader const & shader, std::uint32_t block)
+        : mBinding(0), mDirty(false)
+    {
+        // Size the Staging Copy and Collect Member Offsets from Reflection
+        glGenBuffers(1, & mBuffer);
+        auto reflected = shader.block(block);
+        if (!reflected) return;
+        mBinding = reflected->binding;
+        mData.resize(reflected->size);
+        for (auto & i : shader.uniforms())
+            if (i.block == static_cast<GLint>(reflected->index)) mMembers.push_back(i);
+        glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, mData.size(), mData.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void UniformBuffer::flush()
+    {
+        // Orphan and Refill Once, Then Attach to the Shared Binding Point
+        if (mDirty && !mData.empty())
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+            glBufferData(GL_UNIFORM_BUFFER, mData.size(), mData.data(), GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            mDirty = false;
+        }   glBindBufferBase(GL_UNIFORM_BUFFER, mBinding, mBuffer);
+    }
 };
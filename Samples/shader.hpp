@@ -1,12 +1,19 @@
 #pragma once
 
+// Local Headers
+#include "program.hpp"
+
 // System Headers
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 // Standard Headers
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 
 // Define Namespace
 namespace Mirage
@@ -15,23 +22,58 @@ namespace Mirage
     {
     public:
 
+        // Reflected Active Uniform; Block Members Have No Location
+        struct Uniform {
+            std::uint32_t hash;
+            GLint  location;
+            GLenum type;
+            GLint  count;
+            GLint  block;
+            GLint  offset;
+            GLint  unit;
+        };
+
+        // Reflected Uniform Block
+        struct Block {
+            std::uint32_t hash;
+            GLuint index;
+            GLint  size;
+            GLuint binding;
+        };
+
+        // Hash Uniform Names with 32-bit FNV-1a; Literals Hash at Compile Time
+        static constexpr std::uint32_t hash(char const * name, std::uint32_t seed = 2166136261u)
+        { return * name ? hash(name + 1, (seed ^ static_cast<unsigned char>(* name)) * 16777619u) : seed; }
+
         // Implement Custom Constructor and Destructor
-         Shader() { mProgram = glCreateProgram(); }
-        ~Shader() { glDeleteProgram(mProgram); }
+         Shader() : mStatus(GL_FALSE), mReady(false) { mProgram = glCreateProgram(); }
+        ~Shader();
 
         // Public Member Functions
         Shader & activate();
         Shader & attach(std::string const & filename);
         GLuint   create(std::string const & filename);
-        GLuint   get() { return mProgram; }
+        GLuint   get() const { return mProgram; }
         Shader & link();
 
+        // Queue on the Global ShaderCompiler Instead of Linking Now; Usable Once ready()
+        Shader & compile();
+        bool     ready() const { return mReady; }
+
+        // Query the Reflected Tables; Handles Are Uniform Locations
+        Uniform const * find(std::uint32_t hash) const;
+        Block   const * block(std::uint32_t hash) const;
+        GLint uniform(std::uint32_t hash) const { auto i = find(hash); return i ? i->location : -1; }
+        GLint unit(std::uint32_t hash)    const { auto i = find(hash); return i ? i->unit     : -1; }
+        std::vector<Uniform> const & uniforms() const { return mUniforms; }
+
         // Wrap Calls to glUniform
-        void bind(unsigned int location, float value);
-        void bind(unsigned int location, glm::mat4 const & matrix);
+        void bind(unsigned int location, float value) const;
+        void bind(unsigned int location, glm::vec3 const & vector) const;
+        void bind(unsigned int location, glm::mat4 const & matrix) const;
         template<typename T> Shader & bind(std::string const & name, T&& value)
         {
-            int location = glGetUniformLocation(mProgram, name.c_str());
+            int location = uniform(hash(name.c_str()));
             if (location == -1) fprintf(stderr, "Missing Uniform: %s\n", name.c_str());
             else bind(location, std::forward<T>(value));
             return *this;
@@ -43,10 +85,64 @@ namespace Mirage
         Shader(Shader const &) = delete;
         Shader & operator=(Shader const &) = delete;
 
+        // The Compiler Finishes Programs Queued by compile()
+        friend class ShaderCompiler;
+
+        // Private Member Functions
+        void complete(bool linked);
+        void reflect();
+        static GLenum type(std::string const & filename);
+
+        // Private Member Containers
+        std::vector<ShaderStage> mStages;
+        std::vector<Uniform> mUniforms;
+        std::vector<Block>   mBlocks;
+
         // Private Member Variables
         GLuint mProgram;
         GLint  mStatus;
-        GLint  mLength;
+        bool   mReady;
+
+    };
+
+    // CPU Copy of a Uniform Block, Uploaded Once per flush()
+    class UniformBuffer
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+         UniformBuffer(Shader const & shader, std::uint32_t block);
+        ~UniformBuffer() { glDeleteBuffers(1, & mBuffer); }
+
+        // Stage a Member Value; Unknown Members Are Ignored
+        template<typename T> UniformBuffer & set(std::uint32_t member, T const & value)
+        {
+            for (auto & i : mMembers)
+                if (i.hash == member && i.offset + sizeof(T) <= mData.size())
+                {
+                    std::memcpy(& mData[i.offset], & value, sizeof(T));
+                    mDirty = true;
+                }
+            return *this;
+        }
+
+        // Public Member Functions
+        void flush();
+
+    private:
+
+        // Disable Copying and Assignment
+        UniformBuffer(UniformBuffer const &) = delete;
+        UniformBuffer & operator=(UniformBuffer const &) = delete;
+
+        // Private Member Containers
+        std::vector<Shader::Uniform> mMembers;
+        std::vector<unsigned char> mData;
+
+        // Private Member Variables
+        GLuint mBuffer;
+        GLuint mBinding;
+        bool   mDirty;
 
     };
 };
@@ -0,0 +1,205 @@
+// Local Headers
+#include "cache.hpp"
+#include "optimize.hpp"
+#include "simplify.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Symmetric 4x4 Sum of Squared Plane Distances, Weighted by Triangle Area
+        struct Quadric {
+            double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+            double b0  = 0, b1  = 0, b2  = 0, c   = 0, weight = 0;
+
+            Quadric & operator+=(Quadric const & q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+                b0  += q.b0;  b1  += q.b1;  b2  += q.b2;  c   += q.c;   weight += q.weight;
+                return * this;
+            }
+
+            void plane(glm::vec3 const & a, glm::vec3 const & b, glm::vec3 const & p)
+            {
+                glm::vec3 normal = glm::cross(b - a, p - a);
+                double area = glm::length(normal);
+                if (area <= 0.0) return;
+                double x = normal.x / area, y = normal.y / area, z = normal.z / area;
+                double d = -(x * a.x + y * a.y + z * a.z);
+                a00 += area * x * x; a01 += area * x * y; a02 += area * x * z;
+                a11 += area * y * y; a12 += area * y * z; a22 += area * z * z;
+                b0  += area * x * d; b1  += area * y * d; b2  += area * z * d;
+                c   += area * d * d; weight += area;
+            }
+
+            // Mean Squared Distance of a Point from the Accumulated Planes
+            double error(glm::vec3 const & p) const
+            {
+                double x = p.x, y = p.y, z = p.z;
+                double sum = a00 * x * x + a11 * y * y + a22 * z * z
+                           + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                           + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                return weight > 0.0 ? std::max(sum, 0.0) / weight : 0.0;
+            }
+        };
+
+        struct Collapse {
+            GLuint from;
+            GLuint to;
+            double cost;
+        };
+
+        std::uint64_t edge(GLuint a, GLuint b)
+        {
+            return a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a;
+        }
+
+        // Stop Adding Levels Once a Pass Removes Less Than This Fraction of Triangles
+        const float kMinReduction = 0.1f;
+    }
+
+    float simplify(Vertex const * vertices, std::size_t vertexCount,
+                   GLuint const * indices,  std::size_t indexCount,
+                   std::size_t target, std::vector<GLuint> & result)
+    {
+        result.assign(indices, indices + indexCount);
+        if (indexCount <= target) return 0.0f;
+
+        // Weld Vertices by Position, so Collapses See Through Normal and UV Splits
+        std::vector<GLuint> group(vertexCount);
+        std::vector<GLuint> members(vertexCount, 0);
+        std::unordered_map<std::uint64_t, GLuint> positions;
+        for (std::size_t i = 0; i < vertexCount; i++)
+        {
+            auto & position = vertices[i].position;
+            auto inserted = positions.insert(std::make_pair(
+                MeshCache::hash(& position, sizeof(position)), static_cast<GLuint>(i)));
+            bool same = inserted.second || vertices[inserted.first->second].position == position;
+            group[i] = same ? inserted.first->second : static_cast<GLuint>(i);
+            members[group[i]]++;
+        }
+
+        // Lock Seams and Open Borders; Moving Either Would Tear the Surface
+        std::vector<char> locked(vertexCount, 0);
+        std::unordered_map<std::uint64_t, unsigned int> edges;
+        std::vector<Quadric> quadrics(vertexCount);
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            GLuint a = group[indices[i]], b = group[indices[i + 1]], p = group[indices[i + 2]];
+            Quadric q;
+            q.plane(vertices[a].position, vertices[b].position, vertices[p].position);
+            quadrics[a] += q; quadrics[b] += q; quadrics[p] += q;
+            edges[edge(a, b)]++; edges[edge(b, p)]++; edges[edge(p, a)]++;
+        }
+        for (auto & i : edges) if (i.second == 1) locked[i.first >> 32] = locked[i.first & 0xFFFFFFFF] = 1;
+        for (std::size_t i = 0; i < vertexCount; i++) if (members[group[i]] > 1 || locked[group[i]]) locked[i] = 1;
+
+        std::vector<GLuint> remap(vertexCount);
+        std::vector<GLuint> offsets(vertexCount + 1);
+        std::vector<GLuint> adjacency;
+        std::vector<Collapse> candidates;
+        std::vector<char> touched(vertexCount);
+        double error = 0.0;
+        while (result.size() > target)
+        {
+            // Triangles Around Each Vertex, in Compressed Rows
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (auto i : result) offsets[i + 1]++;
+            for (std::size_t i = 0; i < vertexCount; i++) offsets[i + 1] += offsets[i];
+            adjacency.resize(result.size());
+            std::vector<GLuint> fill(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < result.size(); i++) adjacency[fill[result[i]]++] = static_cast<GLuint>(i / 3);
+
+            // Cost of Moving Each Free Endpoint onto the Other
+            candidates.clear();
+            for (std::size_t i = 0; i < result.size(); i++)
+            {
+                GLuint from = result[i], to = result[i - i % 3 + (i + 1) % 3];
+                for (int j = 0; j < 2; j++, std::swap(from, to))
+                {
+                    if (locked[from]) continue;
+                    Quadric q = quadrics[group[from]];
+                    q += quadrics[group[to]];
+                    Collapse collapse = { from, to, q.error(vertices[to].position) };
+                    candidates.push_back(collapse);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(),
+                      [](Collapse const & a, Collapse const & b) { return a.cost < b.cost; });
+
+            // Each Collapse Removes About Two Triangles; Vertices Move at Most Once per Pass
+            std::size_t budget = (result.size() - target) / 6 + 1, collapses = 0;
+            std::fill(touched.begin(), touched.end(), 0);
+            for (std::size_t i = 0; i < vertexCount; i++) remap[i] = static_cast<GLuint>(i);
+            for (auto & collapse : candidates)
+            {
+                if (collapses >= budget) break;
+                if (touched[collapse.from] || touched[collapse.to]) continue;
+
+                // Reject Collapses That Would Flip a Surviving Triangle
+                bool flips = false;
+                auto & moved = vertices[collapse.to].position;
+                for (GLuint j = offsets[collapse.from]; j < offsets[collapse.from + 1] && !flips; j++)
+                {
+                    GLuint corners[3];
+                    for (int k = 0; k < 3; k++) corners[k] = remap[result[adjacency[j] * 3 + k]];
+                    if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) continue;
+                    if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) continue;
+                    glm::vec3 p[3], q[3];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        p[k] = vertices[corners[k]].position;
+                        q[k] = corners[k] == collapse.from ? moved : p[k];
+                    }
+                    flips = glm::dot(glm::cross(p[1] - p[0], p[2] - p[0]), glm::cross(q[1] - q[0], q[2] - q[0])) <= 0.0f;
+                }
+                if (flips) continue;
+
+                remap[collapse.from] = collapse.to;
+                touched[collapse.from] = touched[collapse.to] = 1;
+                quadrics[group[collapse.to]] += quadrics[group[collapse.from]];
+                error = std::max(error, collapse.cost);
+                collapses++;
+            }
+            if (collapses == 0) break;
+
+            // Apply the Pass, Dropping Triangles That Lost an Edge
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < result.size(); i += 3)
+            {
+                GLuint a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+                if (a == b || b == c || c == a) continue;
+                result[count++] = a; result[count++] = b; result[count++] = c;
+            }   result.resize(count);
+        }   return static_cast<float>(std::sqrt(error));
+    }
+
+    std::vector<LevelOfDetail> simplify(std::vector<Vertex> const & vertices,
+                                        std::vector<GLuint> & indices, unsigned int levels)
+    {
+        auto base = static_cast<std::uint32_t>(indices.size());
+        std::vector<LevelOfDetail> chain(1, LevelOfDetail { 0, base, 0.0f });
+        std::vector<GLuint> level;
+        for (unsigned int i = 1; i <= levels; i++)
+        {
+            // Always Decimate the Original, so Errors Measure RMS Distance from the Real Surface
+            std::size_t target = (base / 3 >> i) * 3;
+            if (target < 3) break;
+            float error = simplify(vertices.data(), vertices.size(), indices.data(), base, target, level);
+            if (level.size() > (1.0f - kMinReduction) * chain.back().count) break;
+            optimizeVertexCache(level.data(), level.size(), vertices.size());
+
+            LevelOfDetail lod = { static_cast<std::uint32_t>(indices.size()),
+                                  static_cast<std::uint32_t>(level.size()),
+                                  std::max(error, chain.back().error) };
+            indices.insert(indices.end(), level.begin(), level.end());
+            chain.push_back(lod);
+        }   return chain;
+    }
+};
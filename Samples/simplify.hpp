@@ -0,0 +1,25 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Collapse Edges in Order of Quadric Error Until at Most target Indices Remain. Vertices
+    // Only Move onto Existing Ones, so the Result Indexes the Same Vertex Buffer. Borders and
+    // Attribute Seams Stay Fixed. Returns the Largest RMS Quadric Error of Any Collapse, in Model
+    // Units: the Area-Weighted RMS Distance from the Merged Planes, Not a Bound on the Deviation.
+    float simplify(Vertex const * vertices, std::size_t vertexCount,
+                   GLuint const * indices,  std::size_t indexCount,
+                   std::size_t target, std::vector<GLuint> & result);
+
+    // Append Up to levels Coarser Copies of the Index Buffer, Each Targeting Half the Triangles
+    // of the Last. Returns the Chain, Finest First, with Level 0 Covering the Original Indices.
+    std::vector<LevelOfDetail> simplify(std::vector<Vertex> const & vertices,
+                                        std::vector<GLuint> & indices, unsigned int levels);
+};
@@ -0,0 +1,176 @@
+// Local Headers
+#include "skeleton.hpp"
+
+// System Headers
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Assimp Matrices Are Row-Major; glm Stores Columns
+        glm::mat4 convert(aiMatrix4x4 const & m)
+        {
+            return glm::mat4(glm::vec4(m.a1, m.b1, m.c1, m.d1), glm::vec4(m.a2, m.b2, m.c2, m.d2),
+                             glm::vec4(m.a3, m.b3, m.c3, m.d3), glm::vec4(m.a4, m.b4, m.c4, m.d4));
+        }
+
+        // Clips Without a Rate Are Assumed to Run at Assimp's Default
+        const double kTicksPerSecond = 25.0;
+
+        // Key at or Before a Time, and How Far Along It Is Toward the Next
+        template<typename T>
+        std::size_t locate(std::vector<std::pair<float, T>> const & keys, float time, float & alpha)
+        {
+            auto next = std::upper_bound(keys.begin(), keys.end(), time,
+                [](float t, std::pair<float, T> const & key) { return t < key.first; });
+            alpha = 0.0f;
+            if (next == keys.begin()) return 0;
+            if (next == keys.end()) return keys.size() - 1;
+            auto index = static_cast<std::size_t>(next - keys.begin()) - 1;
+            float span = next->first - keys[index].first;
+            alpha = span > 0.0f ? (time - keys[index].first) / span : 0.0f;
+            return index;
+        }
+
+        glm::vec3 interpolate(std::vector<std::pair<float, glm::vec3>> const & keys, float time)
+        {
+            float alpha;
+            auto i = locate(keys, time, alpha);
+            return alpha > 0.0f ? glm::mix(keys[i].second, keys[i + 1].second, alpha) : keys[i].second;
+        }
+
+        glm::quat interpolate(std::vector<std::pair<float, glm::quat>> const & keys, float time)
+        {
+            float alpha;
+            auto i = locate(keys, time, alpha);
+            return alpha > 0.0f ? glm::slerp(keys[i].second, keys[i + 1].second, alpha) : keys[i].second;
+        }
+    }
+
+    Skeleton::Skeleton(aiScene const * scene)
+    {
+        // Every Node Becomes a Joint, so Rigid Parts Can Follow Animated Nodes Too
+        parse(scene->mRootNode, none);
+        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+        {
+            auto animation = scene->mAnimations[i];
+            double rate = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : kTicksPerSecond;
+            Clip clip;
+            clip.name = animation->mName.C_Str();
+            clip.duration = static_cast<float>(animation->mDuration / rate);
+            for (unsigned int j = 0; j < animation->mNumChannels; j++)
+            {
+                auto source = animation->mChannels[j];
+                auto joint  = mNames.find(source->mNodeName.C_Str());
+                if (joint == mNames.end()) continue;
+                Channel channel;
+                channel.joint = joint->second;
+                for (unsigned int k = 0; k < source->mNumPositionKeys; k++)
+                {
+                    auto & key = source->mPositionKeys[k];
+                    channel.positions.push_back(std::make_pair(static_cast<float>(key.mTime / rate),
+                        glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z)));
+                }
+                for (unsigned int k = 0; k < source->mNumRotationKeys; k++)
+                {
+                    auto & key = source->mRotationKeys[k];
+                    channel.rotations.push_back(std::make_pair(static_cast<float>(key.mTime / rate),
+                        glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z)));
+                }
+                for (unsigned int k = 0; k < source->mNumScalingKeys; k++)
+                {
+                    auto & key = source->mScalingKeys[k];
+                    channel.scales.push_back(std::make_pair(static_cast<float>(key.mTime / rate),
+                        glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z)));
+                }
+                clip.channels.push_back(std::move(channel));
+            }
+            add(clip);
+        }
+    }
+
+    std::uint32_t Skeleton::joint(std::uint32_t parent, glm::mat4 const & local, std::string const & name)
+    {
+        auto index = static_cast<std::uint32_t>(mParents.size());
+        mParents.push_back(parent);
+        mLocals.push_back(local);
+        mNames.insert(std::make_pair(name, index));
+        for (auto & i : mTracks) i.push_back(none);
+        return index;
+    }
+
+    std::uint32_t Skeleton::bone(std::uint32_t joint, glm::mat4 const & offset)
+    {
+        auto index = static_cast<std::uint32_t>(mBones.size());
+        mBones.push_back(joint);
+        mOffsets.push_back(offset);
+        return index;
+    }
+
+    std::uint32_t Skeleton::bone(aiBone const * bone)
+    {
+        // Meshes Sharing a Joint Share Its Bone; Assimp Repeats the Offset in Each
+        auto joint = mNames.find(bone->mName.C_Str());
+        if (joint == mNames.end()) return none;
+        auto bound = mBound.find(joint->second);
+        if (bound != mBound.end()) return bound->second;
+        auto index = this->bone(joint->second, convert(bone->mOffsetMatrix));
+        mBound.insert(std::make_pair(joint->second, index));
+        return index;
+    }
+
+    std::size_t Skeleton::add(Clip const & clip)
+    {
+        mClips.push_back(clip);
+        mTracks.push_back(std::vector<std::uint32_t>(joints(), none));
+        for (std::size_t i = 0; i < clip.channels.size(); i++)
+            mTracks.back()[clip.channels[i].joint] = static_cast<std::uint32_t>(i);
+        return mClips.size() - 1;
+    }
+
+    void Skeleton::sample(std::size_t clip, float time, glm::mat4 * joints, glm::mat4 * palette) const
+    {
+        // Parents Precede Children, so One Pass Resolves Every Joint
+        Clip const * playing = clip < mClips.size() ? & mClips[clip] : nullptr;
+        if (playing && playing->duration > 0.0f)
+            time = std::fmod(time, playing->duration) + (time < 0.0f ? playing->duration : 0.0f);
+        for (std::size_t i = 0; i < mParents.size(); i++)
+        {
+            glm::mat4 local = mLocals[i];
+            auto track = playing ? mTracks[clip][i] : none;
+            if (track != none)
+            {
+                // Tracks Left Empty Keep the Bind Pose's Component, Which Most Clips Never Need
+                auto & channel = playing->channels[track];
+                glm::vec3 position(local[3]), scale(1.0f);
+                glm::quat rotation;
+                if (channel.rotations.empty() || channel.scales.empty())
+                {
+                    glm::vec3 x(local[0]), y(local[1]), z(local[2]);
+                    scale    = glm::vec3(glm::length(x), glm::length(y), glm::length(z));
+                    rotation = glm::quat_cast(glm::mat3(x / scale.x, y / scale.y, z / scale.z));
+                }
+                if (!channel.positions.empty()) position = interpolate(channel.positions, time);
+                if (!channel.rotations.empty()) rotation = interpolate(channel.rotations, time);
+                if (!channel.scales.empty())    scale    = interpolate(channel.scales, time);
+                local = glm::scale(glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation), scale);
+            }
+            joints[i] = mParents[i] == none ? local : joints[mParents[i]] * local;
+        }
+        for (std::size_t i = 0; i < mBones.size(); i++)
+            palette[i] = joints[mBones[i]] * mOffsets[i];
+    }
+
+    void Skeleton::parse(aiNode const * node, std::uint32_t parent)
+    {
+        auto index = joint(parent, convert(node->mTransformation), node->mName.C_Str());
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+            parse(node->mChildren[i], index);
+    }
+};
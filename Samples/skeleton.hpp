@@ -0,0 +1,96 @@
+#pragma once
+
+// System Headers
+#include <assimp/scene.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Four Strongest Bone Influences of a Vertex, Weights Summing to One; Shaders Read the
+    // Bones at Location 9 and the Weights at Location 10
+    struct VertexWeights {
+        GLushort bones[4];
+        GLfloat  weights[4];
+    };
+
+    // Keyframes of One Joint; Times Are in Seconds and Increase Along Each Track
+    struct Channel {
+        std::uint32_t joint;
+        std::vector<std::pair<float, glm::vec3>> positions;
+        std::vector<std::pair<float, glm::quat>> rotations;
+        std::vector<std::pair<float, glm::vec3>> scales;
+    };
+
+    // Named Animation; Joints Without a Channel Hold Their Bind Pose
+    struct Clip {
+        std::string name;
+        float duration = 0.0f; // Seconds
+        std::vector<Channel> channels;
+    };
+
+    // Joint Hierarchy of a Model, the Bones Its Skinned Meshes Reference, and Its Clips
+    class Skeleton
+    {
+    public:
+
+        // Parent of Root Joints
+        static const std::uint32_t none = 0xFFFFFFFF;
+
+        // Implement Custom Constructors; Imported Joints Mirror the Scene's Nodes Depth-First
+        Skeleton() = default;
+        explicit Skeleton(aiScene const * scene);
+
+        // Append a Joint After Its Parent; Returns Its Index
+        std::uint32_t joint(std::uint32_t parent, glm::mat4 const & local, std::string const & name);
+
+        // Bone Following a Joint, with the Offset from Mesh Space into the Joint's Space
+        std::uint32_t bone(std::uint32_t joint, glm::mat4 const & offset);
+
+        // Bone Named by an Imported Mesh, Added on First Use; none if No Joint Matches
+        std::uint32_t bone(aiBone const * bone);
+
+        // Add a Clip Whose Channels Name Joints by Index; Returns Its Index
+        std::size_t add(Clip const & clip);
+
+        // Pose Every Joint at a Time in a Clip, Wrapping Around Its Duration, and Write Each
+        // Joint's Model-Space Transform and Each Bone's Skinning Matrix; Clips Past the Last
+        // Sample the Bind Pose
+        void sample(std::size_t clip, float time, glm::mat4 * joints, glm::mat4 * palette) const;
+
+        // Public Member Functions
+        std::size_t joints() const { return mParents.size(); }
+        std::size_t bones()  const { return mBones.size(); }
+        std::vector<Clip> const & clips() const { return mClips; }
+
+    private:
+
+        // Disable Copying and Assignment
+        Skeleton(Skeleton const &) = delete;
+        Skeleton & operator=(Skeleton const &) = delete;
+
+        // Private Member Functions
+        void parse(aiNode const * node, std::uint32_t parent);
+
+        // Private Member Containers
+        std::vector<std::uint32_t> mParents;
+        std::vector<glm::mat4> mLocals;
+        std::vector<std::uint32_t> mBones;  // Joint Each Bone Follows
+        std::vector<glm::mat4> mOffsets;
+        std::vector<Clip> mClips;
+        std::vector<std::vector<std::uint32_t>> mTracks; // Channel of Each Joint, per Clip
+        std::map<std::string, std::uint32_t> mNames;
+        std::map<std::uint32_t, std::uint32_t> mBound;   // Bone Already Following a Joint
+
+    };
+};
@@ -0,0 +1,171 @@
+// Local Headers
+#include "platform.hpp"
+#include "stream.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Blocking Waits Poll in Slices of One Millisecond
+        const GLuint64 kTimeout = 1000000;
+
+        // Buffers Are Bound Here for Mapping, so Element and Vertex Bindings Stay Untouched
+        const GLenum kScratch = GL_COPY_WRITE_BUFFER;
+
+        std::size_t align(std::size_t offset, std::size_t alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    StreamBuffer::StreamBuffer(GLenum target, std::size_t size, unsigned int regions)
+        : mFences(std::max(regions, 1u), nullptr)
+        , mSize(std::max<std::size_t>(size, 1)), mAlignment(4)
+        , mHead(0), mMappedFrom(0), mRegion(0), mMapped(nullptr)
+        , mPersistent(GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+    {
+        // Bindable Ranges of Uniform and Storage Buffers Must Start on the Driver's Alignment
+        GLint alignment = 0;
+        if (target == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, & alignment);
+        if (target == GL_SHADER_STORAGE_BUFFER) glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, & alignment);
+        mAlignment = std::max<std::size_t>(mAlignment, alignment);
+        mSize = align(mSize, std::max<std::size_t>(mAlignment, 16)); // Regions Start Aligned for Any vec4 Record
+
+        GLsizeiptr total = static_cast<GLsizeiptr>(mSize * mFences.size());
+        glGenBuffers(1, & mBuffer);
+        glBindBuffer(kScratch, mBuffer);
+        if (mPersistent)
+        {
+            // Mapped Once for the Buffer's Lifetime; Coherent, so Writes Need No Flush
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(kScratch, total, nullptr, flags);
+            mMapped = static_cast<unsigned char *>(glMapBufferRange(kScratch, 0, total, flags));
+        }
+        else glBufferData(kScratch, total, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(kScratch, 0);
+    }
+
+    StreamBuffer::~StreamBuffer()
+    {
+        if (mMapped)
+        {
+            glBindBuffer(kScratch, mBuffer);
+            glUnmapBuffer(kScratch);
+            glBindBuffer(kScratch, 0);
+        }
+        for (auto & i : mFences) if (i) glDeleteSync(i);
+        glDeleteBuffers(1, & mBuffer);
+    }
+
+    bool StreamBuffer::reserve(std::unique_ptr<StreamBuffer> & stream, GLenum target,
+                               std::size_t bytes, unsigned int regions)
+    {
+        // Grow Geometrically; GL Keeps the Old Ring Alive Until Draws Reading It Finish
+        if (stream && stream->capacity() >= bytes) { stream->advance(); return false; }
+        std::size_t capacity = stream ? stream->capacity() : 1;
+        while (capacity < bytes) capacity *= 2;
+        stream.reset(new StreamBuffer(target, capacity, regions));
+        return true;
+    }
+
+    StreamBuffer::Allocation StreamBuffer::allocate(std::size_t size, std::size_t alignment)
+    {
+        Allocation allocation = { nullptr, 0, 0 };
+        if (size > mSize) { mStats.failed++; return allocation; }
+        alignment = std::max(alignment, mAlignment);
+        std::size_t offset = align(mHead, alignment);
+
+        if (mPersistent)
+        {
+            // Only advance() May Fence, Once the Frame's Draws Are Queued; Fencing Here Would Signal
+            // Before Those Draws Read the Region, so a Full Region Fails and Callers Grow the Ring
+            if (offset + size > (mRegion + 1) * mSize) { mStats.failed++; return allocation; }
+            mHead = offset + size;
+            allocation.data = mMapped + offset;
+        }
+        else
+        {
+            // Ranges Past the Head Are Unused by Queued Draws, so Map Them Without Waiting;
+            // At the End, Orphan the Storage Instead of Waiting for the Start to Free Up
+            std::size_t total = mSize * mFences.size();
+            if (offset + size > total)
+            {
+                flush();
+                glBindBuffer(kScratch, mBuffer);
+                glBufferData(kScratch, static_cast<GLsizeiptr>(total), nullptr, GL_STREAM_DRAW);
+                glBindBuffer(kScratch, 0);
+                mStats.orphans++;
+                offset = 0;
+            }
+            if (mMapped == nullptr)
+            {
+                glBindBuffer(kScratch, mBuffer);
+                mMapped = static_cast<unsigned char *>(glMapBufferRange(kScratch,
+                    static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(total - offset),
+                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                    GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+                glBindBuffer(kScratch, 0);
+                mMappedFrom = offset;
+            }
+            mHead = offset + size;
+            allocation.data = mMapped + (offset - mMappedFrom);
+        }
+
+        allocation.offset = static_cast<GLintptr>(offset);
+        allocation.size   = static_cast<GLsizeiptr>(size);
+        return allocation;
+    }
+
+    StreamBuffer::Allocation StreamBuffer::write(void const * data, std::size_t size, std::size_t alignment)
+    {
+        auto allocation = allocate(size, alignment);
+        if (allocation.data) std::copy_n(static_cast<unsigned char const *>(data), size,
+                                         static_cast<unsigned char *>(allocation.data));
+        return allocation;
+    }
+
+    void StreamBuffer::flush()
+    {
+        if (mPersistent || mMapped == nullptr) return;
+        glBindBuffer(kScratch, mBuffer);
+        glFlushMappedBufferRange(kScratch, 0, static_cast<GLsizeiptr>(mHead - mMappedFrom));
+        glUnmapBuffer(kScratch);
+        glBindBuffer(kScratch, 0);
+        mMapped = nullptr;
+    }
+
+    void StreamBuffer::advance()
+    {
+        // Without Storage the Ring Runs on Until It Orphans, so There Is Nothing to Fence
+        if (!mPersistent) return flush();
+        if (mFences[mRegion]) glDeleteSync(mFences[mRegion]);
+        mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mRegion = (mRegion + 1) % static_cast<unsigned int>(mFences.size());
+        mHead = mRegion * mSize;
+        wait(mRegion);
+    }
+
+    void StreamBuffer::wait(unsigned int region)
+    {
+        GLsync fence = mFences[region];
+        if (fence == nullptr) return;
+
+        // Poll First; Only a Fence That Has Not Signalled Counts as a Wait
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            auto start = Clock::now();
+            mStats.waits++;
+            do status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kTimeout);
+            while (status == GL_TIMEOUT_EXPIRED);
+            mStats.waited += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        glDeleteSync(fence);
+        mFences[region] = nullptr;
+    }
+};
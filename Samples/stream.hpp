@@ -0,0 +1,87 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Ring of Per-Frame Regions for Streaming Data to the GPU; Persistently Mapped and Fenced
+    // Where glBufferStorage Exists, Otherwise Mapped Unsynchronized and Orphaned When Full
+    class StreamBuffer
+    {
+    public:
+
+        // Writable Range; offset Is Where Draws Find It in buffer()
+        struct Allocation {
+            void *     data;
+            GLintptr   offset;
+            GLsizeiptr size;
+        };
+
+        // Fence Waits Mean the Ring Is Too Small for the Frames in Flight
+        struct Stats {
+            std::size_t waits   = 0;
+            double      waited  = 0.0; // Milliseconds Blocked in Fence Waits
+            std::size_t orphans = 0;
+            std::size_t failed  = 0;   // Requests That Did Not Fit What Was Left of the Region
+        };
+
+        // Frames in Flight Before a Ring Waits; Each Frame Takes One Region
+        static const unsigned int kRegions = 3;
+
+        // Implement Custom Constructor and Destructor; Size Is per Region
+         StreamBuffer(GLenum target, std::size_t size, unsigned int regions = kRegions);
+        ~StreamBuffer();
+
+        // Reserve Space in the Current Region; Data Is Null if the Region Has No Room Left
+        Allocation allocate(std::size_t size, std::size_t alignment = 16);
+        Allocation write(void const * data, std::size_t size, std::size_t alignment = 16);
+
+        // Make Writes Visible Before Drawing; Persistent Mappings Are Coherent Already
+        void flush();
+
+        // Fence the Frame's Region and Move to the Next, Waiting Only if the GPU Still Reads It
+        void advance();
+
+        // Advance the Ring if a Region Holds Bytes, Otherwise Replace It with One Twice as Large
+        // Until It Does; Returns Whether the Buffer Changed, so Views of It Must Be Rebound
+        static bool reserve(std::unique_ptr<StreamBuffer> & stream, GLenum target,
+                            std::size_t bytes, unsigned int regions = kRegions);
+
+        // Public Member Functions
+        GLuint buffer() const { return mBuffer; }
+        bool persistent() const { return mPersistent; }
+        std::size_t capacity() const { return mSize; } // Bytes per Region
+        Stats const & stats() const { return mStats; }
+
+    private:
+
+        // Disable Copying and Assignment
+        StreamBuffer(StreamBuffer const &) = delete;
+        StreamBuffer & operator=(StreamBuffer const &) = delete;
+
+        // Private Member Functions
+        void wait(unsigned int region);
+
+        // Private Member Containers
+        std::vector<GLsync> mFences;
+
+        // Private Member Variables
+        GLuint mBuffer;
+        std::size_t mSize;
+        std::size_t mAlignment;
+        std::size_t mHead;
+        std::size_t mMappedFrom;
+        unsigned int mRegion;
+        unsigned char * mMapped;
+        bool mPersistent;
+        Stats mStats;
+
+    };
+};
@@ -0,0 +1,250 @@
+// Local Headers
+#include "cache.hpp"
+#include "platform.hpp"
+#include "profiler.hpp"
+#include "texture.hpp"
+
+// System Headers
+#include <stb_image.h>
+
+// Standard Headers
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Define Namespace
+namespace Mirage
+{
+    TextureLoader::TextureLoader(ThreadPool & pool) : mPool(pool)
+    {
+        glGenBuffers(1, & mPixelBuffer);
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        finish();
+        glDeleteBuffers(1, & mPixelBuffer);
+    }
+
+    GLuint TextureLoader::request(std::string const & filename)
+    {
+        // Reserve the Texture Name Now, so Callers Can Reference It Immediately
+        Pending pending;
+        glGenTextures(1, & pending.texture);
+        pending.filename = filename;
+        pending.image = mPool.submit([filename]() {
+            auto start = Clock::now();
+            Image image;
+            image.data = nullptr;
+
+            // Prefer the Baked Mip Chain, Decoding the Source Only When the Driver Cannot Sample It
+            auto compressed = std::make_shared<CompressedTexture>(CompressedTexture::path(filename));
+            if (compressed->valid() && supported(compressed->format())) image.compressed = compressed;
+            else image.data = stbi_load(filename.c_str(), & image.width, & image.height, & image.channels, 0);
+            image.decode = milliseconds(start);
+            return image;
+        });
+        mPending.push_back(std::move(pending));
+        return mPending.back().texture;
+    }
+
+    void TextureLoader::finish()
+    {
+        // Upload Images in Completion Order, Blocking Only When Nothing Is Ready
+        while (!mPending.empty())
+        {
+            auto ready = mPending.end();
+            for (auto i = mPending.begin(); i != mPending.end() && ready == mPending.end(); ++i)
+                if (i->image.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                    ready = i;
+            if (ready == mPending.end())
+            {
+                auto start = Clock::now();
+                mPending.front().image.wait();
+                mReport.stall += milliseconds(start);
+                ready = mPending.begin();
+            }
+
+            Image image = ready->image.get();
+            mReport.decode += image.decode;
+            if (image.compressed) upload(* ready, * image.compressed);
+            else if (!image.data) fprintf(stderr, "%s %s\n", "Failed to Load Texture", ready->filename.c_str());
+            else upload(* ready, image);
+            stbi_image_free(image.data);
+            mPending.erase(ready);
+        }
+    }
+
+    bool TextureLoader::stage(void const * data, std::size_t bytes)
+    {
+        // Stage Pixels in an Orphaned Pixel Buffer, so Texture Uploads Return Without Copying
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        void * staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (staging)
+        {
+            std::memcpy(staging, data, bytes);
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) return true;
+        }
+
+        // The Mapping Failed or Its Contents Were Lost; Upload Straight from Client Memory
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        mReport.unstaged += 1;
+        return false;
+    }
+
+    void TextureLoader::upload(Pending & pending, Image const & image)
+    {
+        // Set the Correct Channel Format
+        GLenum format;
+        switch (image.channels)
+        {
+            case 1  : format = GL_RED;  break;
+            case 2  : format = GL_RG;   break;
+            case 3  : format = GL_RGB;  break;
+            default : format = GL_RGBA; break;
+        }
+
+        std::size_t bytes = std::size_t(image.width) * image.height * image.channels;
+        bool staged = stage(image.data, bytes);
+
+        // Bind Texture and Set Filtering Levels; Reading GPU Timers Back Here Would Wait for Every
+        // Upload, so Only the Profiler Times Them on the GPU, Inside Profiled Frames
+        MIRAGE_PROFILE_GPU("texture upload");
+        glBindTexture(GL_TEXTURE_2D, pending.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        auto start = Clock::now();
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height,
+                     0, format, GL_UNSIGNED_BYTE, staged ? nullptr : image.data);
+        auto uploaded = Clock::now();
+        glGenerateMipmap(GL_TEXTURE_2D);
+        mReport.upload += std::chrono::duration<double, std::milli>(uploaded - start).count();
+        mReport.mipmap += milliseconds(uploaded);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // Record Statistics; the Mip Chain Adds Roughly a Third
+        mReport.textures += 1;
+        mReport.bytes    += bytes;
+        TextureRegistry::global().resident(pending.texture, bytes + bytes / 3);
+    }
+
+    void TextureLoader::upload(Pending & pending, CompressedTexture const & texture)
+    {
+        // The Whole Chain Is One Contiguous Range of the Mapping; Copy It Once
+        bool staged = stage(texture.data(), texture.size());
+
+        // Upload Every Prebuilt Level; There Is No Mipmap Pass
+        MIRAGE_PROFILE_GPU("texture upload");
+        auto & levels = texture.levels();
+        glBindTexture(GL_TEXTURE_2D, pending.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < levels.size(); i++)
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat(texture.format()),
+                                   levels[i].width, levels[i].height, 0, static_cast<GLsizei>(levels[i].size),
+                                   staged ? reinterpret_cast<void const *>(levels[i].offset)
+                                          : texture.data() + levels[i].offset);
+        mReport.upload += milliseconds(start);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // Record Statistics; Resident Size Is Exact
+        mReport.textures   += 1;
+        mReport.compressed += 1;
+        mReport.bytes      += texture.size();
+        TextureRegistry::global().resident(pending.texture, texture.size());
+    }
+
+    TextureRegistry & TextureRegistry::global()
+    {
+        static TextureRegistry registry;
+        return registry;
+    }
+
+    GLuint TextureRegistry::acquire(std::string const & filename, TextureLoader & loader)
+    {
+        // Look Up by Resolved Path First, Then Optionally by File Contents
+        auto path = normalize(filename);
+        auto found = mPaths.find(path);
+        std::uint64_t hash = 0;
+        if (found == mPaths.end() && mHashContents)
+        {
+            MappedFile file(path);
+            if (file.valid()) hash = MeshCache::hash(file.data(), file.size());
+            auto alias = mHashes.find(hash);
+            if (hash != 0 && alias != mHashes.end())
+                found = mPaths.insert(std::make_pair(path, alias->second)).first;
+        }
+
+        if (found != mPaths.end())
+        {
+            mStats.hits++;
+            mEntries[found->second].references++;
+            return found->second;
+        }
+
+        // Decode and Upload Each Image Exactly Once
+        GLuint texture = loader.request(path);
+        Entry entry = { path, hash, 1, 0 };
+        mEntries.insert(std::make_pair(texture, entry));
+        mPaths.insert(std::make_pair(path, texture));
+        if (hash != 0) mHashes.insert(std::make_pair(hash, texture));
+        mStats.misses++;
+        mStats.textures++;
+        return texture;
+    }
+
+    void TextureRegistry::release(GLuint texture)
+    {
+        auto found = mEntries.find(texture);
+        if (found == mEntries.end() || --found->second.references > 0) return;
+
+        // Drop Every Alias Pointing at This Texture
+        for (auto i = mPaths.begin(); i != mPaths.end();)
+            if (i->second == texture) i = mPaths.erase(i); else ++i;
+        if (found->second.hash != 0) mHashes.erase(found->second.hash);
+        mStats.textures--;
+        mStats.bytes -= found->second.bytes;
+        mEntries.erase(found);
+        glDeleteTextures(1, & texture);
+    }
+
+    void TextureRegistry::resident(GLuint texture, std::size_t bytes)
+    {
+        auto found = mEntries.find(texture);
+        if (found == mEntries.end()) return;
+        mStats.bytes += bytes - found->second.bytes;
+        found->second.bytes = bytes;
+    }
+
+    std::string TextureRegistry::normalize(std::string const & filename)
+    {
+        // Collapse Separators, "." and ".." Lexically, so Equivalent Paths Share a Key
+        std::vector<std::string> parts;
+        std::string part, path = filename;
+        for (auto & c : path) if (c == '\\') c = '/';
+        for (std::size_t start = 0, end; start <= path.size(); start = end + 1)
+        {
+            end = path.find('/', start);
+            if (end == std::string::npos) end = path.size();
+            part = path.substr(start, end - start);
+                 if (part.empty() || part == ".") continue;
+            else if (part == ".." && !parts.empty() && parts.back() != "..") parts.pop_back();
+            else parts.push_back(part);
+        }
+
+        std::string result = (!path.empty() && path[0] == '/') ? "/" : "";
+        for (std::size_t i = 0; i < parts.size(); i++)
+            result += (i > 0 ? "/" : "") + parts[i];
+        return result;
+    }
+};
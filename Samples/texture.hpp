@@ -0,0 +1,138 @@
+#pragma once
+
+// Local Headers
+#include "compress.hpp"
+#include "threadpool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Decodes Images on Worker Threads; Uploads Happen on the GL Thread. A Baked .dds Beside the
+    // Source Is Mapped and Uploaded As Is When the Driver Supports Its Format.
+    class TextureLoader
+    {
+    public:
+
+        // Load-Time Breakdown in Milliseconds
+        struct Report {
+            std::size_t textures   = 0;
+            std::size_t compressed = 0; // Uploaded from a Baked Mip Chain
+            std::size_t unstaged   = 0; // Uploaded from Client Memory After Staging Failed
+            std::size_t bytes      = 0;
+            double decode = 0.0; // Summed Worker Time
+            double stall  = 0.0; // GL Thread Waiting on Workers
+            double upload = 0.0; // GL Thread Time Issuing Texture Uploads
+            double mipmap = 0.0; // GL Thread Time Issuing glGenerateMipmap
+        };
+
+        // Implement Custom Constructor and Destructor
+        explicit TextureLoader(ThreadPool & pool = ThreadPool::global());
+        ~TextureLoader();
+
+        // Public Member Functions
+        GLuint request(std::string const & filename);
+        void finish();
+        Report const & report() const { return mReport; }
+
+    private:
+
+        // Disable Copying and Assignment
+        TextureLoader(TextureLoader const &) = delete;
+        TextureLoader & operator=(TextureLoader const &) = delete;
+
+        // Decoded Image Owned by stb_image, or a Mapped Compressed Texture
+        struct Image {
+            unsigned char * data;
+            int width, height, channels;
+            double decode;
+            std::shared_ptr<CompressedTexture> compressed;
+        };
+
+        struct Pending {
+            GLuint texture;
+            std::string filename;
+            std::future<Image> image;
+        };
+
+        // Private Member Functions
+        void upload(Pending & pending, Image const & image);
+        void upload(Pending & pending, CompressedTexture const & texture);
+        bool stage(void const * data, std::size_t bytes);
+
+        // Private Member Containers
+        std::vector<Pending> mPending;
+
+        // Private Member Variables
+        ThreadPool & mPool;
+        GLuint mPixelBuffer;
+        Report mReport;
+
+    };
+
+    // Reference-Counted Textures Shared Across Every Mesh; GL Thread Only
+    class TextureRegistry
+    {
+    public:
+
+        // Lookup and Residency Counters
+        struct Stats {
+            std::size_t hits     = 0;
+            std::size_t misses   = 0;
+            std::size_t textures = 0;
+            std::size_t bytes    = 0;
+        };
+
+        // Process-Wide Registry
+        static TextureRegistry & global();
+
+        // Public Member Functions
+        GLuint acquire(std::string const & filename, TextureLoader & loader);
+        void   release(GLuint texture);
+        void   resident(GLuint texture, std::size_t bytes);
+        Stats const & stats() const { return mStats; }
+
+        // Also Match Identical Images Stored Under Different Paths
+        void hashContents(bool enabled) { mHashContents = enabled; }
+
+    private:
+
+        // Implement Default Constructor
+        TextureRegistry() : mHashContents(false) {}
+
+        // Disable Copying and Assignment
+        TextureRegistry(TextureRegistry const &) = delete;
+        TextureRegistry & operator=(TextureRegistry const &) = delete;
+
+        struct Entry {
+            std::string   path;
+            std::uint64_t hash;
+            std::size_t   references;
+            std::size_t   bytes;
+        };
+
+        // Private Member Functions
+        static std::string normalize(std::string const & filename);
+
+        // Private Member Containers
+        std::unordered_map<GLuint, Entry> mEntries;
+        std::unordered_map<std::string, GLuint> mPaths;
+        std::unordered_map<std::uint64_t, GLuint> mHashes;
+
+        // Private Member Variables
+        Stats mStats;
+        bool  mHashContents;
+
+    };
+};
@@ -0,0 +1,48 @@
+// Local Headers
+#include "threadpool.hpp"
+
+// Define Namespace
+namespace Mirage
+{
+    ThreadPool::ThreadPool(std::size_t threads) : mStopping(false)
+    {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 0; i < threads; i++)
+            mWorkers.push_back(std::thread(& ThreadPool::run, this));
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }   mSignal.notify_all();
+        for (auto & i : mWorkers) i.join();
+    }
+
+    ThreadPool & ThreadPool::global()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task)
+    {
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.push(std::move(task));
+        }   mSignal.notify_one();
+    }
+
+    void ThreadPool::run()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {   std::unique_lock<std::mutex> lock(mMutex);
+                mSignal.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+                if (mStopping && mTasks.empty()) return;
+                task = std::move(mTasks.front());
+                mTasks.pop();
+            }   task();
+        }
+    }
+};
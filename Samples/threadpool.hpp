@@ -0,0 +1,95 @@
+#pragma once
+
+// Standard Headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    class ThreadPool
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+        explicit ThreadPool(std::size_t threads = 0);
+        ~ThreadPool();
+
+        // Process-Wide Pool Sized to the Hardware
+        static ThreadPool & global();
+
+        // Public Member Functions
+        std::size_t size() const { return mWorkers.size(); }
+
+        // Queue a Task and Return a Future for Its Result
+        template<typename F>
+        auto submit(F && task) -> std::future<decltype(task())>
+        {
+            typedef decltype(task()) R;
+            auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+            auto future = packaged->get_future();
+            enqueue([packaged]() { (*packaged)(); });
+            return future;
+        }
+
+        // Run body(i) for Every i in [0, count); the Caller Helps Out, so Nesting Is Safe
+        template<typename F>
+        void parallel(std::size_t count, F && body)
+        {
+            if (count == 0) return;
+            struct State {
+                std::atomic<std::size_t> next;
+                std::size_t done;
+                std::mutex mutex;
+                std::condition_variable finished;
+            };
+            auto state = std::make_shared<State>();
+            state->next = 0;
+            state->done = 0;
+            auto work = [state, count, &body]() {
+                std::size_t completed = 0;
+                for (std::size_t i = state->next++; i < count; i = state->next++, completed++)
+                    body(i);
+                if (completed == 0) return;
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if ((state->done += completed) == count) state->finished.notify_all();
+            };
+
+            // Late Helpers Find No Work Left and Never Touch body
+            std::size_t helpers = std::min(size(), count - 1);
+            for (std::size_t i = 0; i < helpers; i++) enqueue(work);
+            work();
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finished.wait(lock, [&]() { return state->done == count; });
+        }
+
+    private:
+
+        // Disable Copying and Assignment
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool & operator=(ThreadPool const &) = delete;
+
+        // Private Member Functions
+        void enqueue(std::function<void()> task);
+        void run();
+
+        // Private Member Containers
+        std::vector<std::thread> mWorkers;
+        std::queue<std::function<void()>> mTasks;
+
+        // Private Member Variables
+        std::mutex mMutex;
+        std::condition_variable mSignal;
+        bool mStopping;
+
+    };
+};